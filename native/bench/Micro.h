@@ -0,0 +1,28 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+
+// Microbenchmarks run with `--micro NAME`. Each sets a rewritten routine
+// against the reference it replaced, prints accuracy and timing, and returns
+// nonzero when the accuracy leaves the bound the rewrite was accepted with.
+// Timings are host figures: compare the ratio, not the absolute numbers.
+int microFill();
+int microBezier();
+int microMath();
+int microGrid();
+int microChain();
+int microSchool();
+
+// Mean nanoseconds per call of fn over reps calls, best of three runs
+template <typename Fn>
+double nsPerCall(int reps, Fn fn) {
+    double best = 0;
+    for (int run = 0; run < 3; run++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < reps; i++) fn();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / reps;
+        if (run == 0 || ns < best) best = ns;
+    }
+    return best;
+}
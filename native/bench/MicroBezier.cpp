@@ -0,0 +1,143 @@
+// --micro bezier: the adaptive curve helpers against a 64-segment
+// reference, with the fixed ten-step helpers they replaced alongside. The
+// adaptive curves may not differ from the reference in more pixels than the
+// ten-step ones did.
+#include <Arduino.h>
+
+#include "Micro.h"
+#include "animation/Random.h"
+#include "animation/helper.h"
+
+#define BEZIER_WIDTH 320
+#define BEZIER_HEIGHT 240
+#define BEZIER_BLOBS 60
+#define BEZIER_BLOB_POINTS 8
+#define BEZIER_REFERENCE_SEGMENTS 64
+#define BEZIER_FILL 0x07E0
+#define BEZIER_STROKE 0xF800
+
+namespace {
+
+typedef void (*CurveFn)(LGFX_Sprite *sprite, Point anchor, const Point &start, const Point &control, const Point &end, bool fill);
+
+// Steps t by 0.1 like the original helpers, which stopped short of t = 1
+void fixedCurve(LGFX_Sprite *sprite, Point anchor, const Point &p0, const Point &p1, const Point &p2, bool fill) {
+    float oldX = p0.x, oldY = p0.y;
+    for (float t = 0.1f; t <= 1.0f; t += 0.1f) {
+        float invT = 1.0f - t;
+        float x = invT * invT * p0.x + 2 * invT * t * p1.x + t * t * p2.x;
+        float y = invT * invT * p0.y + 2 * invT * t * p1.y + t * t * p2.y;
+        if (fill) sprite->fillTriangle((int)anchor.x, (int)anchor.y, (int)oldX, (int)oldY, (int)x, (int)y, BEZIER_FILL);
+        else sprite->drawLine((int)oldX, (int)oldY, (int)x, (int)y, BEZIER_STROKE);
+        oldX = x;
+        oldY = y;
+    }
+}
+
+void referenceCurve(LGFX_Sprite *sprite, Point anchor, const Point &p0, const Point &p1, const Point &p2, bool fill) {
+    float oldX = p0.x, oldY = p0.y;
+    for (int i = 1; i <= BEZIER_REFERENCE_SEGMENTS; i++) {
+        float t = (float)i / BEZIER_REFERENCE_SEGMENTS;
+        float invT = 1.0f - t;
+        float x = invT * invT * p0.x + 2 * invT * t * p1.x + t * t * p2.x;
+        float y = invT * invT * p0.y + 2 * invT * t * p1.y + t * t * p2.y;
+        if (fill) sprite->fillTriangle((int)anchor.x, (int)anchor.y, (int)oldX, (int)oldY, (int)x, (int)y, BEZIER_FILL);
+        else sprite->drawLine((int)oldX, (int)oldY, (int)x, (int)y, BEZIER_STROKE);
+        oldX = x;
+        oldY = y;
+    }
+}
+
+void adaptiveCurve(LGFX_Sprite *sprite, Point anchor, const Point &p0, const Point &p1, const Point &p2, bool fill) {
+    if (fill) fillQuadraticBezier(sprite, anchor, p0.x, p0.y, p1.x, p1.y, p2.x, p2.y, BEZIER_FILL);
+    else drawQuadraticBezier(sprite, p0.x, p0.y, p1.x, p1.y, p2.x, p2.y, BEZIER_STROKE);
+}
+
+struct Blob {
+    Point center;
+    Point points[BEZIER_BLOB_POINTS];
+};
+
+// Closed blobs like the leaf and ripple outlines: a fill fanned from the
+// centre, then a stroke, through midpoints with the points as controls
+void drawBlob(LGFX_Sprite *sprite, const Blob &blob, CurveFn curve) {
+    for (int pass = 0; pass < 2; pass++) {
+        const Point *p = blob.points;
+        for (int i = 0; i < BEZIER_BLOB_POINTS; i++) {
+            const Point &before = p[(i + BEZIER_BLOB_POINTS - 1) % BEZIER_BLOB_POINTS];
+            const Point &control = p[i];
+            const Point &after = p[(i + 1) % BEZIER_BLOB_POINTS];
+            Point start = {(before.x + control.x) / 2, (before.y + control.y) / 2};
+            Point end = {(control.x + after.x) / 2, (control.y + after.y) / 2};
+            curve(sprite, blob.center, start, control, end, pass == 0);
+        }
+    }
+}
+
+struct CurveDiff {
+    int covered = 0;
+    int differing = 0;
+};
+
+void compare(const LGFX_Sprite &actual, const LGFX_Sprite &reference, CurveDiff &diff) {
+    const uint16_t *a = (const uint16_t*)actual.getBuffer();
+    const uint16_t *r = (const uint16_t*)reference.getBuffer();
+    for (int y = 0; y < BEZIER_HEIGHT; y++) {
+        for (int x = 0; x < BEZIER_WIDTH; x++) {
+            int i = y * BEZIER_WIDTH + x;
+            if (r[i]) diff.covered++;
+            if (a[i] != r[i]) diff.differing++;
+        }
+    }
+}
+
+} // namespace
+
+int microBezier() {
+    LGFX_Sprite actual, fixed, reference;
+    for (LGFX_Sprite *sprite : {&actual, &fixed, &reference}) {
+        sprite->setColorDepth(16);
+        sprite->createSprite(BEZIER_WIDTH, BEZIER_HEIGHT);
+    }
+
+    int failures = 0;
+    static Blob blobs[BEZIER_BLOBS];
+    for (float radius : {0.4f, 2.0f, 8.0f, 30.0f}) {
+        Random random(1);
+        for (Blob &blob : blobs) {
+            blob.center = {random.range(30, BEZIER_WIDTH - 30), random.range(30, BEZIER_HEIGHT - 30)};
+            for (int i = 0; i < BEZIER_BLOB_POINTS; i++) {
+                float r = radius * random.range(0.96f, 1.04f);
+                float angle = i * 2 * PI / BEZIER_BLOB_POINTS;
+                blob.points[i] = {blob.center.x + r * cosf(angle), blob.center.y + r * sinf(angle)};
+            }
+        }
+
+        // One blob at a time, so overlaps don't hide or add differences
+        CurveDiff adaptiveDiff, fixedDiff;
+        for (const Blob &blob : blobs) {
+            actual.fillScreen(0);
+            fixed.fillScreen(0);
+            reference.fillScreen(0);
+            drawBlob(&actual, blob, adaptiveCurve);
+            drawBlob(&fixed, blob, fixedCurve);
+            drawBlob(&reference, blob, referenceCurve);
+            compare(actual, reference, adaptiveDiff);
+            compare(fixed, reference, fixedDiff);
+        }
+
+        int next = 0;
+        double adaptiveNs = nsPerCall(10000, [&] { drawBlob(&actual, blobs[next++ % BEZIER_BLOBS], adaptiveCurve); });
+        next = 0;
+        double fixedNs = nsPerCall(10000, [&] { drawBlob(&fixed, blobs[next++ % BEZIER_BLOBS], fixedCurve); });
+        printf("bezier       radius %4.1f: %4d of %6d pixels differ from %d segments, ten steps %5d; "
+               "%.0fns per blob, ten steps %.0fns\n",
+               radius, adaptiveDiff.differing, adaptiveDiff.covered, BEZIER_REFERENCE_SEGMENTS,
+               fixedDiff.differing, adaptiveNs, fixedNs);
+        if (adaptiveDiff.differing > fixedDiff.differing) {
+            printf("FAIL         more pixels off the reference than the ten-step curves\n");
+            failures++;
+        }
+    }
+    return failures;
+}
@@ -0,0 +1,292 @@
+// --micro chain: the chain solver with its length as a template parameter,
+// Chain<N>, against the runtime-length Chain it replaced. Both move fish-shaped
+// sets of chains, body plus fins and tails, behind the same Cube targets.
+#include <Arduino.h>
+#include <vector>
+
+#include "Micro.h"
+#include "animation/Random.h"
+#include "animation/fish/Chain.h"
+#include "animation/fish/Cube.h"
+#include "animation/fish/FishSpecies.h"
+
+#define CHAIN_WIDTH 320
+#define CHAIN_HEIGHT 240
+#define CHAIN_FISH 100
+#define CHAIN_TICKS 1000
+#define CHAIN_MAX_LENGTH 20
+
+namespace {
+
+// The normalizeVector helper.h had before it went inline, a call per link
+__attribute__((noinline)) Point outOfLineNormalize(const Point &vector, float magnitude) {
+    float lengthSq = vector.x * vector.x + vector.y * vector.y;
+    if (lengthSq == 0) return { magnitude, 0 };
+    float scale = magnitude * mathInvSqrt(lengthSq);
+    return { vector.x * scale, vector.y * scale };
+}
+
+float coarseAtan2(float y, float x) {
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    if (ax == 0 && ay == 0) return 0.0f;
+
+    bool steep = ay > ax;
+    float z = steep ? ax / ay : ay / ax;
+    float a = z * (0.25f * PI + 0.273f * (1.0f - z));
+    if (steep) a = 0.5f * PI - a;
+    if (x < 0) a = PI - a;
+    return y < 0 ? -a : a;
+}
+
+// The solver half of the runtime-length Chain: the length is a member, the
+// first link a parameter, and every joint is read back from the store
+class RuntimeChain {
+    public:
+        RuntimeChain() = default;
+        RuntimeChain(Circle *joints, float x, float y, float gap, float angle, const std::vector<float> &sizes)
+            : circles_(joints), gap_(gap) {
+            float smallestAngle = (angle * PI) / 180.0f;
+            length_ = sizes.size() > CHAIN_MAX_LENGTH ? CHAIN_MAX_LENGTH : sizes.size();
+            for (int i = 0; i < length_; ++i) {
+                circles_[i] = Circle(x, y, sizes[i] / 2.0f);
+                x += gap;
+            }
+            float phaseStep = length_ * PI * 1.1368f;
+            cosSmallest_ = mathCos(smallestAngle);
+            sinSmallest_ = mathSin(smallestAngle);
+            cosPhaseStep_ = mathCos(phaseStep);
+            sinPhaseStep_ = mathSin(phaseStep);
+        }
+
+        void freeMove(float x, float y, int width, int height) {
+            float acceleration = circles_[0].followPoint(x, y, width, height);
+            frameCount_ += 25.0f * log(0.3f * acceleration + 1.0f);
+            followLinks(1, (PI / 5.0f) * log(2.0f * acceleration + 1.0f));
+        }
+
+        void constrainMove(float x, float y, const Point &idealDirection, float constrainStrength) {
+            circles_[0].teleport(x, y);
+            Point pos1 = circles_[1].getPosition();
+            Point offset = outOfLineNormalize({pos1.x - x, pos1.y - y}, gap_);
+            if (constrainStrength != 0.0f) {
+                float dot = offset.x * idealDirection.x + offset.y * idealDirection.y;
+                float cross = idealDirection.x * offset.y - idealDirection.y * offset.x;
+                float turn = fastAtan2(fabsf(cross), dot) * constrainStrength;
+                if (cross > 0) turn = -turn;
+                float s, c;
+                polySinCos(turn, s, c);
+                offset = { offset.x * c - offset.y * s, offset.x * s + offset.y * c };
+            }
+            circles_[1].teleport(x + offset.x, y + offset.y);
+            followLinks(2);
+        }
+
+        Circle &getCircle(int index) const { return circles_[index]; }
+
+    private:
+        Circle *circles_ = nullptr;
+        float gap_ = 0;
+        float frameCount_ = 0;
+        uint8_t length_ = 0;
+        float cosSmallest_ = 1.0f, sinSmallest_ = 0.0f;
+        float cosPhaseStep_ = 1.0f, sinPhaseStep_ = 0.0f;
+
+        void followLinks(int first, float oscillateScale = 0.0f) {
+            float phaseSin = 0.0f, phaseCos = 1.0f;
+            if (oscillateScale != 0.0f) {
+                float phase = frameCount_ + first * length_ * PI * 1.1368f;
+                phaseSin = mathSin(phase);
+                phaseCos = mathCos(phase);
+            }
+            float invLength = 1.0f / length_;
+
+            for (int i = first; i < length_; i++) {
+                Point target = circles_[i - 1].getPosition();
+                Point self = circles_[i].getPosition();
+                Point offset = outOfLineNormalize({self.x - target.x, self.y - target.y}, gap_);
+                if (oscillateScale != 0.0f) {
+                    float oscillateRadian = phaseSin * oscillateScale * (0.5f + 2.5f * i * invLength);
+                    float s, c;
+                    polySinCos(oscillateRadian, s, c);
+                    offset = { offset.x * c - offset.y * s, offset.x * s + offset.y * c };
+
+                    float nextSin = phaseSin * cosPhaseStep_ + phaseCos * sinPhaseStep_;
+                    phaseCos = phaseCos * cosPhaseStep_ - phaseSin * sinPhaseStep_;
+                    phaseSin = nextSin;
+                }
+
+                if (i >= 2) {
+                    Point other = circles_[i - 2].getPosition();
+                    Point toOther = { other.x - target.x, other.y - target.y };
+                    float lengthProductSq = (toOther.x * toOther.x + toOther.y * toOther.y)
+                                          * (offset.x * offset.x + offset.y * offset.y);
+                    float cosDelta = 1.0f;
+                    if (lengthProductSq != 0) {
+                        cosDelta = (toOther.x * offset.x + toOther.y * offset.y) * mathInvSqrt(lengthProductSq);
+                    }
+                    if (cosDelta > cosSmallest_) {
+                        float side = toOther.x * offset.y - toOther.y * offset.x > 0 ? sinSmallest_ : -sinSmallest_;
+                        Point u = outOfLineNormalize(toOther, gap_);
+                        offset = { u.x * cosSmallest_ - u.y * side, u.x * side + u.y * cosSmallest_ };
+                    }
+                    if (cosDelta > -1.0f) {
+                        float straight = coarseAtan2(-toOther.y, -toOther.x) + PI;
+                        float current = coarseAtan2(offset.y, offset.x);
+                        float nudge = fabsf(straight - current) * 0.001f;
+                        if (toOther.x * offset.y - toOther.y * offset.x <= 0) nudge = -nudge;
+                        float c = 1.0f - 0.5f * nudge * nudge;
+                        float s = nudge * (1.0f - nudge * nudge * (1.0f / 6));
+                        offset = { offset.x * c - offset.y * s, offset.x * s + offset.y * c };
+                    }
+                }
+
+                circles_[i].teleport(target.x + offset.x, target.y + offset.y);
+            }
+        }
+};
+
+// Joints per fish: body, back fin, fins, tails
+constexpr int FISH_JOINTS = FISH_BODY_JOINTS + FISH_BACK_FIN_JOINTS
+                          + FISH_FINS * FISH_FIN_JOINTS + FISH_TAILS * FISH_TAIL_JOINTS;
+
+// Where a fin or tail hangs off the body, and how it turns from it
+struct Attachment {
+    int position;
+    Point turn;
+    float strength;
+};
+
+struct Layout {
+    float x, y, gap;
+    Attachment backFin, fins[FISH_FINS], tails[FISH_TAILS];
+};
+
+// The two chain types behind one interface, so Skeleton can hold either
+struct TemplateChains {
+    template <int N> using Type = Chain<N>;
+    template <int N>
+    static Chain<N> make(Circle *joints, int offset, float x, float y, float gap, float angle) {
+        float sizes[N];
+        for (int i = 0; i < N; i++) sizes[i] = 2.0f + i;
+        return Chain<N>(joints, offset, x, y, gap, angle, sizes);
+    }
+};
+
+struct RuntimeChains {
+    template <int N> using Type = RuntimeChain;
+    template <int N>
+    static RuntimeChain make(Circle *joints, int offset, float x, float y, float gap, float angle) {
+        std::vector<float> sizes(N);
+        for (int i = 0; i < N; i++) sizes[i] = 2.0f + i;
+        return RuntimeChain(joints + offset, x, y, gap, angle, sizes);
+    }
+};
+
+Point heading(const Circle *body, const Attachment &a) {
+    Point start = body[a.position].getPosition();
+    Point next = body[a.position + 1].getPosition();
+    Point d = normalizeVector({next.x - start.x, next.y - start.y}, 1.0f);
+    return { d.x * a.turn.x - d.y * a.turn.y, d.x * a.turn.y + d.y * a.turn.x };
+}
+
+// One fish's chains, laid out in its joints and moved as Fish::update does
+template <typename Chains>
+struct Skeleton {
+    const Layout *layout;
+    typename Chains::template Type<FISH_BODY_JOINTS> body;
+    typename Chains::template Type<FISH_BACK_FIN_JOINTS> backFin;
+    typename Chains::template Type<FISH_FIN_JOINTS> fins[FISH_FINS];
+    typename Chains::template Type<FISH_TAIL_JOINTS> tails[FISH_TAILS];
+
+    Skeleton(Circle *joints, const Layout &l) : layout(&l) {
+        int offset = 0;
+        body = Chains::template make<FISH_BODY_JOINTS>(joints, offset, l.x, l.y, l.gap, 165.0f);
+        offset += FISH_BODY_JOINTS;
+        backFin = Chains::template make<FISH_BACK_FIN_JOINTS>(joints, offset, l.x, l.y, l.gap * 1.5f, 150.0f);
+        offset += FISH_BACK_FIN_JOINTS;
+        for (auto &f : fins) {
+            f = Chains::template make<FISH_FIN_JOINTS>(joints, offset, l.x, l.y, l.gap * 0.8f, 160.0f);
+            offset += FISH_FIN_JOINTS;
+        }
+        for (auto &t : tails) {
+            t = Chains::template make<FISH_TAIL_JOINTS>(joints, offset, l.x, l.y, l.gap * 0.6f, 120.0f);
+            offset += FISH_TAIL_JOINTS;
+        }
+    }
+
+    void update(const Point &target) {
+        body.freeMove(target.x, target.y, CHAIN_WIDTH, CHAIN_HEIGHT);
+        const Circle *spine = &body.getCircle(0);
+        move(backFin, spine, layout->backFin);
+        for (int i = 0; i < FISH_FINS; i++) move(fins[i], spine, layout->fins[i]);
+        for (int i = 0; i < FISH_TAILS; i++) move(tails[i], spine, layout->tails[i]);
+    }
+
+    template <typename Fin>
+    static void move(Fin &fin, const Circle *spine, const Attachment &a) {
+        Point start = spine[a.position].getPosition();
+        fin.constrainMove(start.x, start.y, heading(spine, a), a.strength);
+    }
+};
+
+// Every fish through every tick, from freshly laid out joints
+template <typename Chains>
+void swim(std::vector<Circle> &joints, const std::vector<Layout> &layouts, const std::vector<Point> &targets) {
+    std::vector<Skeleton<Chains>> fish;
+    fish.reserve(CHAIN_FISH);
+    for (int f = 0; f < CHAIN_FISH; f++) fish.emplace_back(&joints[f * FISH_JOINTS], layouts[f]);
+    const Point *target = targets.data();
+    for (int tick = 0; tick < CHAIN_TICKS; tick++) {
+        for (auto &s : fish) s.update(*target++);
+    }
+}
+
+} // namespace
+
+int microChain() {
+    Random random(1);
+    std::vector<Layout> layouts(CHAIN_FISH);
+    std::vector<Cube> cubes;
+    for (Layout &l : layouts) {
+        l.x = random.range(0, CHAIN_WIDTH);
+        l.y = random.range(0, CHAIN_HEIGHT);
+        l.gap = random.range(40, 70) / FISH_BODY_JOINTS;
+        auto attach = [](int position, float radian, float strength) {
+            return Attachment{position, {mathCos(radian), mathSin(radian)}, strength};
+        };
+        l.backFin = attach(4, 0.0f, 0.0f);
+        for (int i = 0; i < FISH_FINS; i++) {
+            l.fins[i] = attach(i < 2 ? 3 : 7, (i % 2 ? -1 : 1) * 1.2f, i < 2 ? 0.3f : 0.8f);
+        }
+        for (int i = 0; i < FISH_TAILS; i++) {
+            l.tails[i] = attach(FISH_BODY_JOINTS - 2, (i % 2 ? -1 : 1) * 0.3f, 0.3f);
+        }
+        cubes.emplace_back(l.x, l.y, 2.5f, random.fork());
+    }
+
+    // Both runs chase the same targets, so the solvers are all that differ
+    std::vector<Point> targets;
+    for (int tick = 0; tick < CHAIN_TICKS; tick++) {
+        for (Cube &c : cubes) {
+            c.update(CHAIN_WIDTH, CHAIN_HEIGHT);
+            targets.push_back(c.getPosition());
+        }
+    }
+
+    std::vector<Circle> templateJoints(CHAIN_FISH * FISH_JOINTS), runtimeJoints(CHAIN_FISH * FISH_JOINTS);
+    swim<TemplateChains>(templateJoints, layouts, targets);
+    swim<RuntimeChains>(runtimeJoints, layouts, targets);
+    int mismatches = 0;
+    for (size_t i = 0; i < templateJoints.size(); i++) {
+        Point a = templateJoints[i].getPosition(), b = runtimeJoints[i].getPosition();
+        if (a.x != b.x || a.y != b.y) mismatches++;
+    }
+
+    double updates = (double)CHAIN_FISH * CHAIN_TICKS;
+    double runtimeNs = nsPerCall(1, [&] { swim<RuntimeChains>(runtimeJoints, layouts, targets); }) / updates;
+    double templateNs = nsPerCall(1, [&] { swim<TemplateChains>(templateJoints, layouts, targets); }) / updates;
+    printf("chain        %d fish x %d ticks: %d of %d joints differ; per fish update runtime-length %.0fns, Chain<N> %.0fns (x%.2f)\n",
+           CHAIN_FISH, CHAIN_TICKS, mismatches, (int)templateJoints.size(), runtimeNs, templateNs, runtimeNs / templateNs);
+    return mismatches;
+}
@@ -0,0 +1,186 @@
+// --micro fill: fillStrip() against the two fillTriangle() calls per
+// segment that Chain::draw used before it.
+#include <Arduino.h>
+#include <cstring>
+
+#include "Micro.h"
+#include "animation/Random.h"
+#include "animation/SpanFill.h"
+#include "animation/fish/FishSpecies.h"
+
+#define FILL_WIDTH 320
+#define FILL_HEIGHT 240
+#define FILL_STRIPS 2000
+#define FILL_COLOR 0x1234
+
+namespace {
+
+struct Strip {
+    int count;
+    Point left[FISH_BODY_JOINTS];
+    Point right[FISH_BODY_JOINTS];
+};
+
+// A chain shaped like Fish lays it out: joints a gap apart along a spine
+// that bends by up to maxBend per joint, widened along each joint's
+// bisector as Chain::draw does. Sizes are diameters. Some hang off the edge.
+Strip randomStrip(Random &random, const float *sizes, int count, float gap, float maxBend) {
+    Point spine[FISH_BODY_JOINTS];
+    float x = random.range(-40, FILL_WIDTH + 40);
+    float y = random.range(-40, FILL_HEIGHT + 40);
+    float heading = random.range(0, 2 * PI);
+    for (int i = 0; i < count; i++) {
+        spine[i] = {x, y};
+        heading += random.range(-maxBend, maxBend);
+        x += gap * cosf(heading);
+        y += gap * sinf(heading);
+    }
+
+    Strip strip;
+    strip.count = count;
+    for (int i = 0; i < count; i++) {
+        // Sum of the unit normals of the links either side of the joint
+        float nx = 0, ny = 0;
+        for (int j = i - 1; j <= i; j++) {
+            if (j < 0 || j + 1 >= count) continue;
+            float dx = spine[j + 1].x - spine[j].x, dy = spine[j + 1].y - spine[j].y;
+            float length = sqrtf(dx * dx + dy * dy);
+            nx -= dy / length;
+            ny += dx / length;
+        }
+        float length = sqrtf(nx * nx + ny * ny);
+        float r = sizes[i] / 2;
+        strip.left[i] = {spine[i].x + r * nx / length, spine[i].y + r * ny / length};
+        strip.right[i] = {spine[i].x - r * nx / length, spine[i].y - r * ny / length};
+    }
+    return strip;
+}
+
+// Bodies and tails of either species at the sizes Controller gives them,
+// bent as far as their joint limits allow
+Strip randomFishStrip(Random &random, int index) {
+    const FishSpecies &species = *FISH_SPECIES[index % FISH_SPECIES_COUNT];
+    float length = 6 * random.range(0.8f, 1.2f) * random.range(species.minLength, species.maxLength);
+    float width = length * random.range(species.minWidthRatio, species.maxWidthRatio);
+    float gap = length / FISH_BODY_JOINTS;
+    float sizes[FISH_BODY_JOINTS];
+    if (index % 4 < 2) {
+        for (int i = 0; i < FISH_BODY_JOINTS; i++) sizes[i] = species.bodyPoints[i] * width;
+        return randomStrip(random, sizes, FISH_BODY_JOINTS, gap, PI - species.bodyAngle * PI / 180);
+    }
+    for (int i = 0; i < FISH_TAIL_JOINTS; i++) sizes[i] = species.tailPoints[i] * width;
+    float tailGap = gap * 0.5f * random.range(species.minTailGap, species.maxTailGap);
+    return randomStrip(random, sizes, FISH_TAIL_JOINTS, tailGap, PI - 120.0f * PI / 180);
+}
+
+// A strip wound into a spiral, crossing its middle rows many times
+Strip coiledStrip() {
+    Strip strip;
+    strip.count = FISH_BODY_JOINTS;
+    for (int i = 0; i < FISH_BODY_JOINTS; i++) {
+        float angle = i * 1.3f;
+        float r = 20 + 6 * i;
+        float x = FILL_WIDTH / 2 + r * cosf(angle), y = FILL_HEIGHT / 2 + r * sinf(angle);
+        strip.left[i] = {x + 3 * cosf(angle), y + 3 * sinf(angle)};
+        strip.right[i] = {x - 3 * cosf(angle), y - 3 * sinf(angle)};
+    }
+    return strip;
+}
+
+void fillTriangles(LGFX_Sprite *sprite, const Strip &strip) {
+    const Point *l = strip.left, *r = strip.right;
+    for (int i = 0; i < strip.count - 1; i++) {
+        sprite->fillTriangle((int)l[i].x, (int)l[i].y, (int)r[i].x, (int)r[i].y, (int)l[i + 1].x, (int)l[i + 1].y, FILL_COLOR);
+        sprite->fillTriangle((int)r[i].x, (int)r[i].y, (int)l[i + 1].x, (int)l[i + 1].y, (int)r[i + 1].x, (int)r[i + 1].y, FILL_COLOR);
+    }
+}
+
+struct FillDiff {
+    int covered = 0;     // pixels the reference fills
+    int differing = 0;
+    int offEdge = 0;     // differing pixels not on the reference's edge
+};
+
+void compare(const LGFX_Sprite &actual, const LGFX_Sprite &reference, FillDiff &diff) {
+    const uint16_t *a = (const uint16_t*)actual.getBuffer();
+    const uint16_t *b = (const uint16_t*)reference.getBuffer();
+    for (int y = 0; y < FILL_HEIGHT; y++) {
+        for (int x = 0; x < FILL_WIDTH; x++) {
+            int i = y * FILL_WIDTH + x;
+            if (b[i]) diff.covered++;
+            if (a[i] == b[i]) continue;
+            diff.differing++;
+            bool edge = x == 0 || y == 0 || x == FILL_WIDTH - 1 || y == FILL_HEIGHT - 1;
+            for (int dy = -1; dy <= 1 && !edge; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    if (b[i + dy * FILL_WIDTH + dx] != b[i]) edge = true;
+                }
+            }
+            if (!edge) diff.offEdge++;
+        }
+    }
+}
+
+} // namespace
+
+int microFill() {
+    LGFX_Sprite actual, reference;
+    actual.setColorDepth(16);
+    actual.createSprite(FILL_WIDTH, FILL_HEIGHT);
+    reference.setColorDepth(16);
+    reference.createSprite(FILL_WIDTH, FILL_HEIGHT);
+
+    Random random(1);
+    static Strip strips[FILL_STRIPS];
+    for (int i = 0; i < FILL_STRIPS; i++) strips[i] = randomFishStrip(random, i);
+
+    int failures = 0;
+    uint32_t overflowsBefore = fillStripOverflows();
+    FillDiff diff;
+    for (const Strip &strip : strips) {
+        actual.fillScreen(0);
+        reference.fillScreen(0);
+        fillStrip(&actual, strip.left, strip.right, strip.count, FILL_COLOR);
+        fillTriangles(&reference, strip);
+        compare(actual, reference, diff);
+    }
+    uint32_t overflows = fillStripOverflows() - overflowsBefore;
+    double share = diff.covered ? (double)diff.differing / diff.covered : 0;
+    printf("fill         %d body and tail strips: %d of %d pixels differ (%.3f%%), %d off the edge, %u fell back\n",
+           FILL_STRIPS, diff.differing, diff.covered, 100 * share, diff.offEdge, overflows);
+    // Rounding may move the edge by a pixel, which the outline stroke is
+    // drawn over; anything further in is a hole or a spill
+    if (diff.offEdge > 0 || overflows > 0) {
+        printf("FAIL         fill differs from triangles beyond the outline edge\n");
+        failures++;
+    }
+
+    // Too many crossings per row for the scanline pass: must fall back to
+    // triangles rather than drop spans
+    Strip coil = coiledStrip();
+    actual.fillScreen(0);
+    reference.fillScreen(0);
+    overflowsBefore = fillStripOverflows();
+    fillStrip(&actual, coil.left, coil.right, coil.count, FILL_COLOR);
+    fillTriangles(&reference, coil);
+    FillDiff coilDiff;
+    compare(actual, reference, coilDiff);
+    overflows = fillStripOverflows() - overflowsBefore;
+    printf("fill         coiled strip: %u fell back, %d of %d pixels differ\n",
+           overflows, coilDiff.differing, coilDiff.covered);
+    if (overflows != 1 || coilDiff.differing > 0) {
+        printf("FAIL         coiled strip lost spans\n");
+        failures++;
+    }
+
+    int next = 0;
+    double stripNs = nsPerCall(20000, [&] {
+        const Strip &strip = strips[next++ % FILL_STRIPS];
+        fillStrip(&actual, strip.left, strip.right, strip.count, FILL_COLOR);
+    });
+    next = 0;
+    double triangleNs = nsPerCall(20000, [&] { fillTriangles(&actual, strips[next++ % FILL_STRIPS]); });
+    printf("fill         scanline %.0fns, triangles %.0fns per strip (x%.2f)\n",
+           stripNs, triangleNs, triangleNs / stripNs);
+    return failures;
+}
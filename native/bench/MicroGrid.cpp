@@ -0,0 +1,86 @@
+// --micro grid: the fish-plant proximity pass through SpatialGrid against
+// testing every fish with every plant.
+#include <Arduino.h>
+#include <vector>
+
+#include "Micro.h"
+#include "SpatialGrid.h"
+#include "animation/Random.h"
+#include "animation/helper.h"
+
+#define GRID_WIDTH 320
+#define GRID_HEIGHT 240
+#define GRID_FISH 50
+// Twice a typical fish width, as Controller's collision passes use
+#define GRID_REACH 24.0f
+
+namespace {
+
+struct Hits {
+    uint32_t count = 0;
+    uint64_t checksum = 0;   // order-independent, so both passes can agree
+
+    void add(int fish, uint32_t plant) {
+        count++;
+        checksum += (uint64_t)(fish + 1) * 2654435761u ^ plant;
+    }
+    bool operator==(const Hits &other) const { return count == other.count && checksum == other.checksum; }
+};
+
+Hits bruteForce(const std::vector<Point> &fish, const std::vector<Point> &plants) {
+    Hits hits;
+    float reachSq = GRID_REACH * GRID_REACH;
+    for (size_t f = 0; f < fish.size(); f++) {
+        for (size_t i = 0; i < plants.size(); i++) {
+            float dSq = distSq(fish[f].x, fish[f].y, plants[i].x, plants[i].y);
+            if (dSq < reachSq && dSq != 0) hits.add(f, i);
+        }
+    }
+    return hits;
+}
+
+// Rebuilds the grid every call, as Controller does every tick
+Hits throughGrid(SpatialGrid &grid, const std::vector<Point> &fish, const std::vector<Point> &plants) {
+    grid.clear();
+    for (const Point &p : plants) grid.add(p.x, p.y);
+    grid.build();
+
+    Hits hits;
+    float reachSq = GRID_REACH * GRID_REACH;
+    for (size_t f = 0; f < fish.size(); f++) {
+        grid.query(fish[f].x, fish[f].y, GRID_REACH, [&](uint32_t i) {
+            float dSq = distSq(fish[f].x, fish[f].y, plants[i].x, plants[i].y);
+            if (dSq < reachSq && dSq != 0) hits.add(f, i);
+        });
+    }
+    return hits;
+}
+
+} // namespace
+
+int microGrid() {
+    SpatialGrid grid;
+    grid.setBounds(GRID_WIDTH, GRID_HEIGHT);
+    Random random(1);
+
+    int failures = 0;
+    // The last count is past 16-bit indices, to catch them wrapping
+    for (int count : {50, 1000, 2000, 4000, 70000}) {
+        std::vector<Point> fish(GRID_FISH), plants(count);
+        // A few plants and fish off the canvas, which the edge cells hold
+        for (Point &p : plants) p = {random.range(-10, GRID_WIDTH + 10), random.range(-10, GRID_HEIGHT + 10)};
+        for (Point &p : fish) p = {random.range(-10, GRID_WIDTH + 10), random.range(-10, GRID_HEIGHT + 10)};
+
+        Hits expected = bruteForce(fish, plants);
+        Hits actual = throughGrid(grid, fish, plants);
+        int reps = count > 10000 ? 5 : 200;
+        double bruteNs = nsPerCall(reps, [&] { bruteForce(fish, plants); });
+        double gridNs = nsPerCall(reps, [&] { throughGrid(grid, fish, plants); });
+        bool same = actual == expected;
+        printf("grid         %5d plants, %d fish: %u hits, grid %u%s; brute force %.1fus, grid with rebuild %.1fus (x%.1f)\n",
+               count, GRID_FISH, expected.count, actual.count, same ? "" : " MISMATCH",
+               bruteNs / 1000, gridNs / 1000, bruteNs / gridNs);
+        if (!same) failures++;
+    }
+    return failures;
+}
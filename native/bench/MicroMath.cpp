@@ -0,0 +1,100 @@
+// --micro math: the POND_FAST_MATH approximations against libm, for worst
+// error over a dense sweep and for time per call.
+#include <Arduino.h>
+
+#include "Micro.h"
+#include "animation/helper.h"
+#include "animation/fish/FishSpecies.h"
+
+// An approximation may move a joint by at most MATH_MAX_PIXEL_ERROR. An angle
+// error at one body joint swings every joint after it, so over a 14-joint
+// body it acts through 1 + 2 + ... + 13 = 91 gaps. The longest fish (comet
+// maxLength 9.0 x 1.2 x 1.5% of the 400 px diagonal of 240x320) has 4.6 px
+// gaps: a 421 px lever, longer than the diagonal a heading acts over. Angle,
+// sin/cos and relative length errors all scale by that lever.
+#define MATH_MAX_PIXEL_ERROR 0.1
+#define MATH_MAX_GAP (400 * 0.015 * 1.2 * 9.0 / FISH_BODY_JOINTS)
+#define MATH_LEVER (MATH_MAX_GAP * FISH_BODY_JOINTS * (FISH_BODY_JOINTS - 1) / 2)
+#define MATH_MAX_ERROR (MATH_MAX_PIXEL_ERROR / MATH_LEVER)
+
+#define MATH_SWEEP 2000000
+#define MATH_REPS 2000000
+
+namespace {
+
+struct MathErrors {
+    double atan2 = 0;
+    double acos = 0;
+    double invSqrt = 0;
+    double polySinCos = 0;
+};
+
+void track(double &worst, double error) {
+    if (error > worst) worst = error;
+}
+
+MathErrors sweep() {
+    MathErrors e;
+    for (int i = 0; i <= MATH_SWEEP; i++) {
+        double f = (double)i / MATH_SWEEP;
+        // atan2 around a circle, at radii from 1e-3 to 1e3
+        double angle = 2 * PI * f;
+        double radius = pow(10.0, -3 + 6 * fmod(f * 7919, 1.0));
+        float ay = (float)(radius * sin(angle)), ax = (float)(radius * cos(angle));
+        track(e.atan2, fabs(fastAtan2(ay, ax) - atan2((double)ay, (double)ax)));
+
+        float c = (float)(-1 + 2 * f);
+        track(e.acos, fabs(fastAcos(c) - acos((double)c)));
+
+        float v = (float)pow(10.0, -3 + 8 * f);
+        track(e.invSqrt, fabs(fastInvSqrt(v) * sqrt((double)v) - 1));
+
+        float p = (float)(-PI + 2 * PI * f);
+        float s, co;
+        polySinCos(p, s, co);
+        track(e.polySinCos, fmax(fabs(s - sin((double)p)), fabs(co - cos((double)p))));
+    }
+    return e;
+}
+
+// Time per call over inputs that change every call, summed and handed to
+// an empty asm so the calls can't be dropped
+template <typename Fn>
+double timeCalls(Fn fn) {
+    return nsPerCall(1, [&] {
+        float sum = 0;
+        for (int i = 0; i < MATH_REPS; i++) sum += fn(i * (1.0f / MATH_REPS));
+        asm volatile("" : : "r"(sum));
+    }) / MATH_REPS;
+}
+
+bool check(const char *name, double error, double bound) {
+    bool ok = error <= bound;
+    printf("math         %-12s max error %.3e (bound %.2e)%s\n", name, error, bound, ok ? "" : "  FAIL");
+    return ok;
+}
+
+void compareTimes(const char *name, double libmNs, double fastNs) {
+    printf("math         %-12s libm %.2fns, fast %.2fns (x%.2f)\n", name, libmNs, fastNs, libmNs / fastNs);
+}
+
+} // namespace
+
+int microMath() {
+    MathErrors e = sweep();
+    int failures = 0;
+    failures += !check("atan2", e.atan2, MATH_MAX_ERROR);
+    failures += !check("acos", e.acos, MATH_MAX_ERROR);
+    failures += !check("invsqrt", e.invSqrt, MATH_MAX_ERROR);
+    failures += !check("polySinCos", e.polySinCos, MATH_MAX_ERROR);
+
+    compareTimes("atan2", timeCalls([](float t) { return atan2f(t - 0.5f, 0.3f - t); }),
+                 timeCalls([](float t) { return fastAtan2(t - 0.5f, 0.3f - t); }));
+    compareTimes("acos", timeCalls([](float t) { return acosf(2 * t - 1); }),
+                 timeCalls([](float t) { return fastAcos(2 * t - 1); }));
+    compareTimes("invsqrt", timeCalls([](float t) { return 1.0f / sqrtf(t + 0.01f); }),
+                 timeCalls([](float t) { return fastInvSqrt(t + 0.01f); }));
+    compareTimes("polySinCos", timeCalls([](float t) { return sinf(2 * t - 1) + cosf(2 * t - 1); }),
+                 timeCalls([](float t) { float s, c; polySinCos(2 * t - 1, s, c); return s + c; }));
+    return failures;
+}
@@ -0,0 +1,50 @@
+// --micro school: what the skeleton store's layout still leaves on the table.
+// Times Fish::update across a FishSchool of 100 fish, one pass over the store
+// per tick, against as many updates of a single fish whose joints never
+// leave L1. Equal times mean the update is bound by the solver's arithmetic,
+// not by walking the joints, so no joint order can make it faster.
+#include <Arduino.h>
+
+#include "Micro.h"
+#include "animation/Random.h"
+#include "animation/fish/FishSchool.h"
+
+#define SCHOOL_WIDTH 320
+#define SCHOOL_HEIGHT 240
+#define SCHOOL_FISH 100
+#define SCHOOL_TICKS 300
+
+namespace {
+
+// Sized and placed the way Controller::begin does it, species alternating
+void fill(FishSchool &school, int count) {
+    Random random(1);
+    float diagonal = sqrtf(SCHOOL_WIDTH * SCHOOL_WIDTH + SCHOOL_HEIGHT * SCHOOL_HEIGHT);
+    school.reserve(count);
+    for (int i = 0; i < count; i++) {
+        const FishSpecies &species = *FISH_SPECIES[i % 2];
+        float length = diagonal * 0.015f * random.range(0.8f, 1.2f) * random.range(species.minLength, species.maxLength);
+        float width = length * random.range(species.minWidthRatio, species.maxWidthRatio);
+        school.emplace_back(species, random.range(0, SCHOOL_WIDTH), random.range(0, SCHOOL_HEIGHT),
+                            length, width, SCHOOL_WIDTH, SCHOOL_HEIGHT, random);
+    }
+}
+
+} // namespace
+
+int microSchool() {
+    FishSchool school, single;
+    fill(school, SCHOOL_FISH);
+    fill(single, 1);
+    Fish &hot = single[0];
+
+    double storeNs = nsPerCall(SCHOOL_TICKS, [&] {
+        for (auto &fish : school) fish.update(SCHOOL_WIDTH, SCHOOL_HEIGHT);
+    }) / SCHOOL_FISH;
+    double hotNs = nsPerCall(SCHOOL_TICKS, [&] {
+        for (int i = 0; i < SCHOOL_FISH; i++) hot.update(SCHOOL_WIDTH, SCHOOL_HEIGHT);
+    }) / SCHOOL_FISH;
+    printf("school       %d fish, %zu B store: per fish update %.0fns walking the store, %.0fns on one cached fish (x%.2f)\n",
+           SCHOOL_FISH, school.bytes(), storeNs, hotNs, storeNs / hotNs);
+    return 0;
+}
@@ -0,0 +1,204 @@
+// Headless frame benchmark. Runs the pond against the host stand-ins in
+// native/ and reports where each frame's time goes.
+//
+//   pio run -e native && .pio/build/native/program [options]
+//     --frames N                     frames to run (default 600)
+//     --fish N --leaves N --weeds N  population (default 5 / 15 / 50)
+//     --seed N                       scene seed (default 1)
+//     --target-fps N MIN MAX         let the density governor vary duckweed
+//                                    between MIN and MAX to hold N fps
+//     --fish-budget US               drop fish detail while a render takes
+//                                    longer than US microseconds
+//     --species N                    mix the first N fish species (default 1)
+//     --band                         band rendering
+//     --indexed                      8-bit palette sprites (full frame only)
+//     --idle                         no scripted button presses
+//     --hash                         hash every frame that reaches the panel
+//     --micro NAME                   run one microbenchmark instead (see
+//                                    Micro.h): fill, bezier, math, grid, chain,
+//                                    school
+//
+// Time is simulated: every frame advances millis() by one SIM_TICK_MS, so
+// runs are repeatable and the hash only changes when the output does. The
+// governor and fish budget are the exception: they measure real frame cost with micros().
+//
+// `pio test -e native` builds the tests in test/ against the same sources;
+// they bring their own main().
+#ifndef PIO_UNIT_TESTING
+#include <Arduino.h>
+#include <chrono>
+#include <cstring>
+
+#include "ButtonGroup.h"
+#include "Controller.h"
+#include "Micro.h"
+#include <Adafruit_NeoPixel.h>
+#include <config.hpp>
+
+// Same wiring as src/main.cpp
+#define LEFT_BUTTON_PIN 21
+#define RIGHT_BUTTON_PIN 26
+#define Bottom_BUTTON_PIN 33
+#define SPREAD_BUTTON_PIN 34
+
+#define LED_PIN 46
+#define LED_COUNT 3
+
+// Scripted presses, in frames, repeating every SCRIPT_PERIOD frames
+#define SCRIPT_PERIOD 480
+
+struct ScriptedPress {
+    uint8_t pin;
+    int from;
+    int to;
+};
+
+static const ScriptedPress SCRIPT[] = {
+    {LEFT_BUTTON_PIN, 60, 150},
+    {RIGHT_BUTTON_PIN, 180, 270},
+    {Bottom_BUTTON_PIN, 300, 390},
+    {SPREAD_BUTTON_PIN, 420, 430},
+};
+
+struct Microbenchmark {
+    const char *name;
+    int (*run)();
+};
+
+static const Microbenchmark MICROBENCHMARKS[] = {
+    {"fill", microFill},
+    {"bezier", microBezier},
+    {"math", microMath},
+    {"grid", microGrid},
+    {"chain", microChain},
+    {"school", microSchool},
+};
+
+static const char *SERIES_LABELS[PROFILE_SERIES] = {
+    "leds", "ripples", "swim", "physics", "collisions", "track",
+    "fence", "draw", "diff", "spans", "pixels"
+};
+
+static LGFX lcd;
+static LGFX_Sprite sprites[2] = { LGFX_Sprite(&lcd), LGFX_Sprite(&lcd) };
+static Adafruit_NeoPixel pixels(LED_COUNT, LED_PIN, NEO_GRB + NEO_KHZ800);
+static ButtonGroup buttons;
+static Controller controller(lcd, &sprites[0], &sprites[1], buttons, pixels);
+
+static void playScript(int frame) {
+    int t = frame % SCRIPT_PERIOD;
+    for (const ScriptedPress &p : SCRIPT) {
+        hostSetPin(p.pin, (t >= p.from && t < p.to) ? LOW : HIGH);
+    }
+}
+
+static uint64_t hashFrame(uint64_t h) {
+    const uint16_t *frame = lcd.frame();
+    for (int i = 0; i < lcd.width() * lcd.height(); i++) {
+        h = (h ^ frame[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+int main(int argc, char **argv) {
+    int frames = 600;
+    int fishes = 5, leaves = 15, weeds = 50;
+    uint32_t seed = 1;
+    int targetFps = 0, minWeeds = 0, maxWeeds = 0;
+    uint32_t fishBudget = 0;
+    int species = 1;
+    bool band = false, idle = false, hash = false, indexed = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(arg, "--frames") && hasValue) frames = atoi(argv[++i]);
+        else if (!strcmp(arg, "--fish") && hasValue) fishes = atoi(argv[++i]);
+        else if (!strcmp(arg, "--leaves") && hasValue) leaves = atoi(argv[++i]);
+        else if (!strcmp(arg, "--weeds") && hasValue) weeds = atoi(argv[++i]);
+        else if (!strcmp(arg, "--seed") && hasValue) seed = strtoul(argv[++i], nullptr, 0);
+        else if (!strcmp(arg, "--target-fps") && i + 3 < argc) {
+            targetFps = atoi(argv[++i]);
+            minWeeds = atoi(argv[++i]);
+            maxWeeds = atoi(argv[++i]);
+        }
+        else if (!strcmp(arg, "--fish-budget") && hasValue) fishBudget = strtoul(argv[++i], nullptr, 0);
+        else if (!strcmp(arg, "--species") && hasValue) species = atoi(argv[++i]);
+        else if (!strcmp(arg, "--band")) band = true;
+        else if (!strcmp(arg, "--indexed")) indexed = true;
+        else if (!strcmp(arg, "--idle")) idle = true;
+        else if (!strcmp(arg, "--hash")) hash = true;
+        else if (!strcmp(arg, "--micro") && hasValue) {
+            const char *name = argv[++i];
+            for (const Microbenchmark &micro : MICROBENCHMARKS) {
+                if (!strcmp(name, micro.name)) return micro.run() ? 1 : 0;
+            }
+            fprintf(stderr, "unknown microbenchmark %s\n", name);
+            return 2;
+        }
+        else {
+            fprintf(stderr, "unknown option %s\n", arg);
+            return 2;
+        }
+    }
+
+    hostUseManualClock(true);
+    buttons.setLeftPin(LEFT_BUTTON_PIN);
+    buttons.setRightPin(RIGHT_BUTTON_PIN);
+    buttons.setBottomPin(Bottom_BUTTON_PIN);
+    buttons.setSpreadPin(SPREAD_BUTTON_PIN);
+    controller.setBandRendering(band);
+    controller.setIndexedColor(indexed);
+    controller.setPopulation(fishes, leaves, weeds);
+    controller.setSeed(seed);
+    if (species < 1) species = 1;
+    if (species > FISH_SPECIES_COUNT) species = FISH_SPECIES_COUNT;
+    controller.setSpecies(FISH_SPECIES, species);
+    if (targetFps > 0) controller.setTargetFps(targetFps, minWeeds, maxWeeds);
+    controller.setFishDetailBudget(fishBudget);
+    controller.begin();
+
+    uint64_t h = 1469598103934665603ull;
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; f++) {
+        if (!idle) playScript(f);
+        hostAdvanceMillis(SIM_TICK_MS);
+        controller.service();
+        if (hash) h = hashFrame(h);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    long long wallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+
+    const Palette &palette = controller.palette();
+    printf("%d frames, %d fish of %d species, %d leaves, %d duckweeds, seed %lu, %s%s\n",
+           frames, fishes, species, leaves, weeds, (unsigned long)seed, band ? "band" : "full frame",
+           palette.indexed() ? ", indexed" : "");
+    // Mean over the whole run; min and p99 over the last PROFILE_WINDOW samples
+    printf("%-12s %10s %10s %10s\n", "per frame", "mean", "min", "p99");
+    const Profiler &profiler = controller.profiler();
+    for (int s = 0; s < PROFILE_SERIES; s++) {
+        ProfileSeries series = (ProfileSeries)s;
+        uint32_t n = profiler.samples(series);
+        ProfileStats stats = profiler.stats(series);
+        unsigned long long mean = n ? profiler.total(series) / n : 0;
+        const char *unit = series < PROFILE_SPANS ? "ns" : "";
+        printf("%-12s %8llu%-2s %8lu%-2s %8lu%-2s\n", SERIES_LABELS[s],
+               mean, unit, (unsigned long)stats.min, unit, (unsigned long)stats.p99, unit);
+    }
+    printf("%-12s %8lldns\n", "wall", frames ? wallNs / frames : 0);
+    printf("panel        %u pushes, %u pixels\n", lcd.pushCount(), lcd.pushedPixels());
+    if (palette.indexed()) printf("palette      %d/%d colours\n", palette.size(), PALETTE_SIZE);
+    printf("leds         %u frames shown, hash %016llx\n",
+           pixels.showCount(), (unsigned long long)pixels.shownHash());
+    Controller::Density density = controller.density();
+    printf("density      level %d/%d, %d duckweeds, %d ripples, ripple cadence x%.2f, intensity %.0f, %luus/frame\n",
+           density.level, GOVERNOR_LEVELS, density.duckWeeds, density.ripples,
+           density.rippleStretch, density.rippleIntensity, (unsigned long)density.frameMicros);
+    if (fishBudget) {
+        printf("fish detail  budget %luus, pressure %.2f/%d\n",
+               (unsigned long)fishBudget, controller.fishDetail().pressure(), FISH_DETAIL_TIERS - 1);
+    }
+    if (hash) printf("hash         %016llx\n", (unsigned long long)h);
+    return 0;
+}
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+#include <Arduino.h>
+#include <vector>
+
+#define NEO_GRB ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_KHZ800 0x0000
+
+// Frames kept by the stand-in, and how many pixels of each
+#define HOST_LED_HISTORY 64
+#define HOST_LED_PIXELS 8
+
+// Host stand-in: keeps the pixel buffer and records every frame show()
+// sends, so runs can check what the strip displayed and how often.
+class Adafruit_NeoPixel {
+    public:
+        Adafruit_NeoPixel(uint16_t n, int16_t pin = 6, uint16_t type = NEO_GRB + NEO_KHZ800)
+            : pixels_(n, 0) { (void)pin; (void)type; }
+        void begin() {}
+        void show() {
+            uint32_t *frame = history_[showCount_ % HOST_LED_HISTORY];
+            for (size_t i = 0; i < HOST_LED_PIXELS; i++) {
+                frame[i] = i < pixels_.size() ? pixels_[i] : 0;
+                hash_ = (hash_ ^ frame[i]) * 1099511628211ull;
+            }
+            ++showCount_;
+        }
+        void setBrightness(uint8_t b) { brightness_ = b; }
+        void setPixelColor(uint16_t n, uint32_t c) { if (n < pixels_.size()) pixels_[n] = c; }
+        uint32_t getPixelColor(uint16_t n) const { return n < pixels_.size() ? pixels_[n] : 0; }
+        uint16_t numPixels() const { return pixels_.size(); }
+        static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) { return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b; }
+
+        uint32_t showCount() const { return showCount_; }
+        // Pixel i of the frame sent `back` shows ago (0 = the latest)
+        uint32_t shownColor(uint32_t back, uint16_t i) const {
+            if (back >= showCount_ || back >= HOST_LED_HISTORY || i >= HOST_LED_PIXELS) return 0;
+            return history_[(showCount_ - 1 - back) % HOST_LED_HISTORY][i];
+        }
+        // FNV-1a over every frame shown
+        uint64_t shownHash() const { return hash_; }
+    private:
+        std::vector<uint32_t> pixels_;
+        uint8_t brightness_ = 255;
+        uint32_t showCount_ = 0;
+        uint32_t history_[HOST_LED_HISTORY][HOST_LED_PIXELS] = {};
+        uint64_t hash_ = 1469598103934665603ull;
+};
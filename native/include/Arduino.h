@@ -0,0 +1,73 @@
+#pragma once
+// Host stand-in for the subset of the Arduino core used by the pond.
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <cstdio>
+#include <algorithm>
+
+#define IRAM_ATTR
+#define INPUT_PULLUP 0x05
+#define LOW 0
+#define HIGH 1
+#define CHANGE 3
+#define NOT_AN_INTERRUPT -1
+
+using std::abs;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+long random(long howbig);
+long random(long howsmall, long howbig);
+uint32_t esp_random();
+
+inline void noInterrupts() {}
+inline void interrupts() {}
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+void attachInterrupt(int irq, void (*fn)(), int mode);
+void detachInterrupt(int irq);
+
+class String : public std::string {
+    public:
+        String() = default;
+        String(const char *s) : std::string(s) {}
+        String(const std::string &s) : std::string(s) {}
+        String(int v) : std::string(std::to_string(v)) {}
+        String(unsigned v) : std::string(std::to_string(v)) {}
+        String(long v) : std::string(std::to_string(v)) {}
+        String(unsigned long v) : std::string(std::to_string(v)) {}
+        String(float v) : std::string(std::to_string(v)) {}
+        const char *c_str() const { return std::string::c_str(); }
+};
+inline String operator+(const String &a, const char *b) { return String(static_cast<const std::string &>(a) + b); }
+
+class HardwareSerial {
+    public:
+        void begin(unsigned long) {}
+        template <typename T> size_t print(const T &v) { return printValue(v); }
+        template <typename T> size_t println(const T &v) { size_t n = printValue(v); std::fputc('\n', stdout); return n + 1; }
+        size_t println() { std::fputc('\n', stdout); return 1; }
+        int printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+        operator bool() const { return true; }
+    private:
+        size_t printValue(const char *s) { return std::fputs(s, stdout), std::char_traits<char>::length(s); }
+        size_t printValue(const String &s) { return printValue(s.c_str()); }
+        size_t printValue(int v) { return std::printf("%d", v); }
+        size_t printValue(unsigned v) { return std::printf("%u", v); }
+        size_t printValue(long v) { return std::printf("%ld", v); }
+        size_t printValue(unsigned long v) { return std::printf("%lu", v); }
+        size_t printValue(float v) { return std::printf("%.2f", v); }
+        size_t printValue(double v) { return std::printf("%.2f", v); }
+};
+extern HardwareSerial Serial;
+
+// Host-only controls for headless runs
+// Freezes millis() until advanced by hand
+void hostUseManualClock(bool on);
+void hostAdvanceMillis(unsigned long ms);
+// Drives an input pin, firing its CHANGE interrupt like a real button
+void hostSetPin(uint8_t pin, int level);
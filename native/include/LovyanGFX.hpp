@@ -0,0 +1,178 @@
+#pragma once
+// Host stand-in for the subset of LovyanGFX used by the pond.
+// Sprites are memory backed and keep the same raw pixel layout as on device
+// (byte-swapped RGB565, or one palette index per byte) so code that writes
+// straight into getBuffer() behaves identically on both targets. The panel
+// keeps every pushed pixel.
+#include <Arduino.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#define SPI2_HOST 1
+#define SPI_DMA_CH_AUTO 3
+
+static constexpr uint16_t TFT_BLACK = 0x0000;
+static constexpr uint16_t TFT_WHITE = 0xFFFF;
+static constexpr uint16_t TFT_DARKGREY = 0x7BEF;
+static constexpr uint16_t TFT_GREEN = 0x07E0;
+static constexpr uint16_t TFT_YELLOW = 0xFFE0;
+
+namespace lgfx {
+
+enum color_depth_t : uint16_t {
+    bit_mask = 0x00FF,
+    has_palette = 0x0800,
+    palette_8bit = 8 | has_palette,
+    rgb565_2Byte = 16,
+};
+
+class LGFXBase {
+    public:
+        virtual ~LGFXBase() = default;
+
+        int32_t width() const { return width_; }
+        int32_t height() const { return height_; }
+        color_depth_t getColorDepth() const { return (color_depth_t)depth_; }
+
+        static uint16_t color565(uint8_t r, uint8_t g, uint8_t b) {
+            return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+        }
+        void setSwapBytes(bool swap) { swapBytes_ = swap; }
+        bool getSwapBytes() const { return swapBytes_; }
+
+        void setClipRect(int32_t x, int32_t y, int32_t w, int32_t h);
+        void clearClipRect() { setClipRect(0, 0, width_, height_); }
+        void getClipRect(int32_t *x, int32_t *y, int32_t *w, int32_t *h) const {
+            *x = clipL_; *y = clipT_; *w = clipR_ - clipL_ + 1; *h = clipB_ - clipT_ + 1;
+        }
+
+        void drawPixel(int32_t x, int32_t y, uint32_t color) { span(x, y, 1, color); }
+        void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) { span(x, y, w, color); }
+        void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+        void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+        void fillScreen(uint32_t color) { fillRect(0, 0, width_, height_, color); }
+        void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+        void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+        void drawCircle(int32_t x, int32_t y, int32_t r, uint32_t color);
+        void fillCircle(int32_t x, int32_t y, int32_t r, uint32_t color);
+        void fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color);
+
+        // Text is rendered as solid 5x7 cells; enough to exercise overlays.
+        void setTextColor(uint32_t fg, uint32_t bg) { textFg_ = fg; textBg_ = bg; }
+        void setTextColor(uint32_t fg) { textFg_ = fg; textBg_ = fg; textTransparent_ = true; }
+        void setTextSize(float) {}
+        void setCursor(int32_t x, int32_t y) { cursorX_ = x; cursorY_ = y; }
+        int32_t fontHeight() const { return 8; }
+        int32_t textWidth(const char *s) const { return 6 * (int32_t)std::strlen(s); }
+        size_t drawString(const char *s, int32_t x, int32_t y);
+        size_t print(const char *s) { size_t n = drawString(s, cursorX_, cursorY_); cursorX_ += 6 * n; return n; }
+
+    protected:
+        virtual void writeSpan(int32_t x, int32_t y, int32_t w, uint32_t color) = 0;
+        void span(int32_t x, int32_t y, int32_t w, uint32_t color);
+
+        int32_t width_ = 0;
+        int32_t height_ = 0;
+        int32_t clipL_ = 0, clipT_ = 0, clipR_ = -1, clipB_ = -1;
+        uint16_t depth_ = 16;
+        bool swapBytes_ = false;
+        uint32_t textFg_ = 0xFFFF, textBg_ = 0;
+        bool textTransparent_ = false;
+        int32_t cursorX_ = 0, cursorY_ = 0;
+};
+
+class Panel_ST7789 {
+    public:
+        struct config_t {
+            int pin_cs = -1, pin_rst = -1, pin_busy = -1;
+            int panel_width = 240, panel_height = 320;
+            int offset_x = 0, offset_y = 0, offset_rotation = 0;
+            int dummy_read_pixel = 8, dummy_read_bits = 1;
+            bool readable = true, invert = false, rgb_order = false, dlen_16bit = false, bus_shared = true;
+            int memory_width = 240, memory_height = 320;
+        };
+        config_t config() const { return cfg_; }
+        void config(const config_t &cfg) { cfg_ = cfg; }
+        void setBus(void *) {}
+    private:
+        config_t cfg_;
+};
+
+class Bus_SPI {
+    public:
+        struct config_t {
+            int spi_host = 0, spi_mode = 0;
+            uint32_t freq_write = 0, freq_read = 0;
+            bool spi_3wire = false, use_lock = false;
+            int dma_channel = 0;
+            int pin_sclk = -1, pin_mosi = -1, pin_miso = -1, pin_dc = -1;
+        };
+        config_t config() const { return cfg_; }
+        void config(const config_t &cfg) { cfg_ = cfg; }
+    private:
+        config_t cfg_;
+};
+
+class Light_PWM {};
+
+// A panel that remembers every pixel pushed to it.
+class LGFX_Device : public LGFXBase {
+    public:
+        void setPanel(Panel_ST7789 *panel) { panel_ = panel; }
+        bool begin();
+        bool init() { return begin(); }
+        void setColorDepth(int bits) { depth_ = bits; }
+        void setRotation(uint8_t r);
+        uint8_t getRotation() const { return rotation_; }
+
+        void startWrite() { ++writeDepth_; }
+        void endWrite() { if (writeDepth_) --writeDepth_; }
+        void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data);
+        void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) { pushImage(x, y, w, h, data); }
+        void waitDMA() {}
+        bool dmaBusy() const { return false; }
+
+        const uint16_t *frame() const { return frame_.data(); }
+        uint32_t pushCount() const { return pushCount_; }
+        uint32_t pushedPixels() const { return pushedPixels_; }
+
+    protected:
+        void writeSpan(int32_t x, int32_t y, int32_t w, uint32_t color) override;
+
+    private:
+        Panel_ST7789 *panel_ = nullptr;
+        uint8_t rotation_ = 0;
+        int writeDepth_ = 0;
+        std::vector<uint16_t> frame_;
+        uint32_t pushCount_ = 0;
+        uint32_t pushedPixels_ = 0;
+};
+
+} // namespace lgfx
+
+class LGFX_Sprite : public lgfx::LGFXBase {
+    public:
+        LGFX_Sprite(lgfx::LGFXBase *parent = nullptr) : parent_(parent) {}
+        ~LGFX_Sprite() override { deleteSprite(); }
+        LGFX_Sprite(const LGFX_Sprite &) = delete;
+        LGFX_Sprite &operator=(const LGFX_Sprite &) = delete;
+
+        void setColorDepth(int bits) { depth_ = bits; }
+        void *createSprite(int32_t w, int32_t h);
+        void deleteSprite();
+        void setBuffer(void *buffer, int32_t w, int32_t h, lgfx::color_depth_t bpp = lgfx::rgb565_2Byte);
+        void *getBuffer() const { return buffer_; }
+
+        uint16_t readPixel(int32_t x, int32_t y) const;
+
+    protected:
+        void writeSpan(int32_t x, int32_t y, int32_t w, uint32_t color) override;
+
+    private:
+        lgfx::LGFXBase *parent_;
+        void *buffer_ = nullptr;
+        bool ownsBuffer_ = false;
+};
+
+using lgfx::LGFX_Device;
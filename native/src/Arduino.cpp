@@ -0,0 +1,74 @@
+#include <Arduino.h>
+#include <chrono>
+#include <cstdarg>
+#include <thread>
+
+HardwareSerial Serial;
+
+namespace {
+const auto startTime = std::chrono::steady_clock::now();
+}
+
+static bool manualClock = false;
+static unsigned long manualMs = 0;
+void hostUseManualClock(bool on) { manualClock = on; }
+void hostAdvanceMillis(unsigned long ms) { manualMs += ms; }
+
+unsigned long millis() {
+    if (manualClock) return manualMs;
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(unsigned long ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+long random(long howbig) { return howbig <= 0 ? 0 : rand() % howbig; }
+long random(long howsmall, long howbig) { return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall); }
+uint32_t esp_random() { return 0x12345678u; }
+
+// Inputs idle HIGH, as with INPUT_PULLUP and nothing pressed
+#define HOST_PINS 64
+static int pinLevels[HOST_PINS];
+static void (*pinHandlers[HOST_PINS])();
+static bool pinsReady = false;
+
+static void initPins() {
+    if (pinsReady) return;
+    for (int i = 0; i < HOST_PINS; ++i) pinLevels[i] = HIGH;
+    pinsReady = true;
+}
+
+void pinMode(uint8_t, uint8_t) {}
+
+int digitalRead(uint8_t pin) {
+    initPins();
+    return pin < HOST_PINS ? pinLevels[pin] : HIGH;
+}
+
+void attachInterrupt(int irq, void (*fn)(), int) {
+    if (irq >= 0 && irq < HOST_PINS) pinHandlers[irq] = fn;
+}
+
+void detachInterrupt(int irq) {
+    if (irq >= 0 && irq < HOST_PINS) pinHandlers[irq] = nullptr;
+}
+
+void hostSetPin(uint8_t pin, int level) {
+    initPins();
+    if (pin >= HOST_PINS || pinLevels[pin] == level) return;
+    pinLevels[pin] = level;
+    if (pinHandlers[pin]) pinHandlers[pin]();
+}
+
+int HardwareSerial::printf(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = std::vprintf(fmt, args);
+    va_end(args);
+    return n;
+}
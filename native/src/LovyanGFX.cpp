@@ -0,0 +1,180 @@
+#include <LovyanGFX.hpp>
+#include <utility>
+
+namespace lgfx {
+
+void LGFXBase::setClipRect(int32_t x, int32_t y, int32_t w, int32_t h) {
+    clipL_ = std::max<int32_t>(0, x);
+    clipT_ = std::max<int32_t>(0, y);
+    clipR_ = std::min<int32_t>(width_ - 1, x + w - 1);
+    clipB_ = std::min<int32_t>(height_ - 1, y + h - 1);
+}
+
+void LGFXBase::span(int32_t x, int32_t y, int32_t w, uint32_t color) {
+    if (y < clipT_ || y > clipB_ || w <= 0) return;
+    int32_t x1 = x + w - 1;
+    if (x < clipL_) x = clipL_;
+    if (x1 > clipR_) x1 = clipR_;
+    if (x1 < x) return;
+    writeSpan(x, y, x1 - x + 1, color);
+}
+
+void LGFXBase::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) {
+    for (int32_t i = 0; i < h; ++i) span(x, y + i, 1, color);
+}
+
+void LGFXBase::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    for (int32_t i = 0; i < h; ++i) span(x, y + i, w, color);
+}
+
+void LGFXBase::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+    span(x, y, w, color);
+    span(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+}
+
+void LGFXBase::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+    int32_t dx = std::abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int32_t dy = -std::abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int32_t err = dx + dy;
+    for (;;) {
+        span(x0, y0, 1, color);
+        if (x0 == x1 && y0 == y1) break;
+        int32_t e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+void LGFXBase::drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+    if (r < 0) return;
+    int32_t x = r, y = 0, err = 1 - r;
+    while (x >= y) {
+        span(x0 + x, y0 + y, 1, color); span(x0 - x, y0 + y, 1, color);
+        span(x0 + x, y0 - y, 1, color); span(x0 - x, y0 - y, 1, color);
+        span(x0 + y, y0 + x, 1, color); span(x0 - y, y0 + x, 1, color);
+        span(x0 + y, y0 - x, 1, color); span(x0 - y, y0 - x, 1, color);
+        ++y;
+        if (err < 0) err += 2 * y + 1;
+        else { --x; err += 2 * (y - x) + 1; }
+    }
+}
+
+void LGFXBase::fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+    if (r < 0) return;
+    for (int32_t dy = -r; dy <= r; ++dy) {
+        int32_t dx = (int32_t)std::sqrt((float)(r * r - dy * dy));
+        span(x0 - dx, y0 + dy, 2 * dx + 1, color);
+    }
+}
+
+void LGFXBase::fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color) {
+    if (y0 > y1) { std::swap(y0, y1); std::swap(x0, x1); }
+    if (y1 > y2) { std::swap(y2, y1); std::swap(x2, x1); }
+    if (y0 > y1) { std::swap(y0, y1); std::swap(x0, x1); }
+    if (y0 == y2) {
+        int32_t a = std::min({x0, x1, x2}), b = std::max({x0, x1, x2});
+        span(a, y0, b - a + 1, color);
+        return;
+    }
+    int32_t dy1 = y1 - y0, dy2 = y2 - y0, dy3 = y2 - y1;
+    for (int32_t y = y0; y <= y2; ++y) {
+        int32_t xa = x0 + (int32_t)((int64_t)(x2 - x0) * (y - y0) / dy2);
+        int32_t xb = (y < y1 || dy3 == 0)
+            ? (dy1 ? x0 + (int32_t)((int64_t)(x1 - x0) * (y - y0) / dy1) : x1)
+            : x1 + (int32_t)((int64_t)(x2 - x1) * (y - y1) / dy3);
+        if (xa > xb) std::swap(xa, xb);
+        span(xa, y, xb - xa + 1, color);
+    }
+}
+
+size_t LGFXBase::drawString(const char *s, int32_t x, int32_t y) {
+    size_t n = 0;
+    for (; *s; ++s, ++n, x += 6) {
+        if (!textTransparent_) fillRect(x, y, 6, 8, textBg_);
+        if (*s != ' ') fillRect(x, y + 1, 5, 7, textFg_);
+    }
+    return n;
+}
+
+bool LGFX_Device::begin() {
+    int w = panel_ ? panel_->config().panel_width : 240;
+    int h = panel_ ? panel_->config().panel_height : 320;
+    width_ = w; height_ = h;
+    frame_.assign((size_t)w * h, 0);
+    clearClipRect();
+    return true;
+}
+
+void LGFX_Device::setRotation(uint8_t r) {
+    if ((r ^ rotation_) & 1) std::swap(width_, height_);
+    rotation_ = r & 7;
+    clearClipRect();
+}
+
+void LGFX_Device::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) {
+    ++pushCount_;
+    pushedPixels_ += (uint32_t)(w * h);
+    for (int32_t j = 0; j < h; ++j) {
+        for (int32_t i = 0; i < w; ++i) {
+            int32_t px = x + i, py = y + j;
+            if (px < 0 || py < 0 || px >= width_ || py >= height_) continue;
+            frame_[(size_t)py * width_ + px] = data[j * w + i];
+        }
+    }
+}
+
+void LGFX_Device::writeSpan(int32_t x, int32_t y, int32_t w, uint32_t color) {
+    uint16_t raw = (uint16_t)((color >> 8) | (color << 8));
+    for (int32_t i = 0; i < w; ++i) frame_[(size_t)y * width_ + x + i] = raw;
+}
+
+} // namespace lgfx
+
+void *LGFX_Sprite::createSprite(int32_t w, int32_t h) {
+    deleteSprite();
+    size_t bytes = (size_t)w * h * ((depth_ & lgfx::bit_mask) / 8);
+    buffer_ = std::calloc(bytes, 1);
+    if (!buffer_) return nullptr;
+    ownsBuffer_ = true;
+    width_ = w; height_ = h;
+    clearClipRect();
+    return buffer_;
+}
+
+void LGFX_Sprite::deleteSprite() {
+    if (ownsBuffer_) std::free(buffer_);
+    buffer_ = nullptr;
+    ownsBuffer_ = false;
+    width_ = height_ = 0;
+    clearClipRect();
+}
+
+void LGFX_Sprite::setBuffer(void *buffer, int32_t w, int32_t h, lgfx::color_depth_t bpp) {
+    deleteSprite();
+    buffer_ = buffer;
+    depth_ = bpp;
+    width_ = w; height_ = h;
+    clearClipRect();
+}
+
+uint16_t LGFX_Sprite::readPixel(int32_t x, int32_t y) const {
+    if (!buffer_ || x < 0 || y < 0 || x >= width_ || y >= height_) return 0;
+    // Palette sprites answer with the index; the host keeps no palette
+    if (depth_ == lgfx::palette_8bit) return static_cast<uint8_t *>(buffer_)[(size_t)y * width_ + x];
+    uint16_t raw = static_cast<uint16_t *>(buffer_)[(size_t)y * width_ + x];
+    return (uint16_t)((raw >> 8) | (raw << 8));
+}
+
+void LGFX_Sprite::writeSpan(int32_t x, int32_t y, int32_t w, uint32_t color) {
+    if (!buffer_) return;
+    // Palette sprites take colours as indices, as on device
+    if (depth_ == lgfx::palette_8bit) {
+        std::memset(static_cast<uint8_t *>(buffer_) + (size_t)y * width_ + x, (uint8_t)color, w);
+        return;
+    }
+    uint16_t raw = (uint16_t)(((color >> 8) & 0xFF) | ((color & 0xFF) << 8));
+    uint16_t *p = static_cast<uint16_t *>(buffer_) + (size_t)y * width_ + x;
+    for (int32_t i = 0; i < w; ++i) p[i] = raw;
+}
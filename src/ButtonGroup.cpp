@@ -9,6 +9,7 @@ ButtonGroup::ButtonGroup(unsigned long debounce_ms, unsigned long long_ms)
 {
     for (uint8_t i = 0; i < MAX_BUTTONS; ++i) {
         pins_[i] = 0;
+        roles_[i] = BUTTON_NONE;
         lastRaw_[i] = true; 
         lastRawChangeMs_[i] = 0;
         pressStartAt_[i] = 0;
@@ -16,21 +17,22 @@ ButtonGroup::ButtonGroup(unsigned long debounce_ms, unsigned long long_ms)
     }
 }
 
-void ButtonGroup::setLeftPin(uint8_t pin) { leftPin_ = pin; addIfMissing(pin); }
-void ButtonGroup::setRightPin(uint8_t pin) { rightPin_ = pin; addIfMissing(pin); }
-void ButtonGroup::setBottomPin(uint8_t pin) { bottomPin_ = pin; addIfMissing(pin); }
-void ButtonGroup::setSpreadPin(uint8_t pin) { spreadPin_ = pin; addIfMissing(pin); }
+void ButtonGroup::setLeftPin(uint8_t pin) { addIfMissing(pin, BUTTON_LEFT); }
+void ButtonGroup::setRightPin(uint8_t pin) { addIfMissing(pin, BUTTON_RIGHT); }
+void ButtonGroup::setBottomPin(uint8_t pin) { addIfMissing(pin, BUTTON_BOTTOM); }
+void ButtonGroup::setSpreadPin(uint8_t pin) { addIfMissing(pin, BUTTON_SPREAD); }
 
 int8_t ButtonGroup::findIndex(uint8_t pin) const {
     for (uint8_t i = 0; i < count_; ++i) if (pins_[i] == pin) return i;
     return -1;
 }
 
-void ButtonGroup::addIfMissing(uint8_t pin) {
+void ButtonGroup::addIfMissing(uint8_t pin, ButtonRole role) {
     if (pin == 0) return;
     if (findIndex(pin) >= 0) return;
     if (count_ >= MAX_BUTTONS) return;
     pins_[count_] = pin;
+    roles_[count_] = role;
     lastRaw_[count_] = true;
     lastRawChangeMs_[count_] = 0;
     pressStartAt_[count_] = 0;
@@ -68,7 +70,6 @@ void IRAM_ATTR ButtonGroup::isr_handler() {
 
 void ButtonGroup::service() {
     noInterrupts();
-    bool changed = isrChanged_;
     uint32_t rawMask = isrMask_;
     isrChanged_ = false;
     interrupts();
@@ -86,7 +87,7 @@ void ButtonGroup::service() {
         }
 
         if (raw != stable && changedAt != 0 && (now - changedAt) >= debounceMs_) {
-            generateEdgeReport(i, raw);
+            queueReport(raw ? BUTTON_PRESS : BUTTON_RELEASE, roles_[i], chordOf(1UL << i), now);
 
             if (raw) { 
                 stableMask_ |= (1UL << i);
@@ -114,13 +115,7 @@ void ButtonGroup::service() {
                         longRegistered_[i] = true;
                         sessionHasLong_ = true;
                         emittedLongMask_ |= (1UL << i);
-                        
-                        Report r;
-                        r.mask = (1UL << i);
-                        r.count = 1;
-                        r.longPress = true;
-                        r.text = buildLabel((1UL << i), true);
-                        queueReport(r);
+                        queueReport(BUTTON_LONG, BUTTON_NONE, chordOf(1UL << i), now);
                     }
                 }
             }
@@ -129,12 +124,7 @@ void ButtonGroup::service() {
 
     if (stableMask_ == 0 && sessionActive_) { 
         if (!(sessionHasLong_ && emittedLongMask_ != 0 && emittedLongMask_ == latchedMask_)) {
-            Report r;
-            r.mask = latchedMask_;
-            r.count = popcount(latchedMask_);
-            r.longPress = sessionHasLong_;
-            r.text = buildLabel(latchedMask_, sessionHasLong_);
-            queueReport(r);
+            queueReport(sessionHasLong_ ? BUTTON_LONG : BUTTON_SHORT, BUTTON_NONE, chordOf(latchedMask_), now);
         }
         latchedMask_ = 0;
         sessionActive_ = false;
@@ -147,74 +137,33 @@ void ButtonGroup::service() {
     }
 }
 
-bool ButtonGroup::poll(Report &out) {
-    noInterrupts();
-    bool empty = (qHead_ == qTail_);
-    if (!empty) {
-        out = reportQueue_[qTail_];
-        qTail_ = (qTail_ + 1) % REPORT_QUEUE_SIZE;
-    }
-    interrupts();
-    return !empty;
+void ButtonGroup::queueReport(ButtonEvent event, ButtonRole role, uint8_t chord, unsigned long now) {
+    // A full ring drops the newest report, as the old queue did
+    reports_.push({event, role, chord, (uint32_t)now});
 }
 
-void ButtonGroup::queueReport(const Report &r) {
-    noInterrupts();
-    uint8_t next = (qHead_ + 1) % REPORT_QUEUE_SIZE;
-    if (next != qTail_) {
-        reportQueue_[qHead_] = r;
-        qHead_ = next;
+uint8_t ButtonGroup::chordOf(uint32_t mask) const {
+    uint8_t chord = 0;
+    for (uint8_t i = 0; i < count_; ++i) {
+        if (mask & (1UL << i)) chord |= 1 << roles_[i];
     }
-    interrupts();
+    return chord;
 }
 
-void ButtonGroup::generateEdgeReport(uint8_t pinIndex, bool isPressed) {
-    uint8_t pin = pins_[pinIndex];
-    String evtText = "";
+void ButtonGroup::describe(const Report &r, char *out, size_t size) {
+    static const char *const ROLE_NAMES[BUTTON_ROLES] = {"none", "left", "right", "bottom", "spread"};
+    static const char *const EVENT_NAMES[BUTTON_EVENTS] = {"in", "out", "short", "long"};
 
-    if (leftPin_ && pin == leftPin_) {
-        evtText = isPressed? "left-in" : "left-out";
+    if (size == 0) return;
+    out[0] = '\0';
+    if (r.event == BUTTON_PRESS || r.event == BUTTON_RELEASE) {
+        snprintf(out, size, "%s-%s", ROLE_NAMES[r.role], EVENT_NAMES[r.event]);
+        return;
     }
-    else if (rightPin_ && pin == rightPin_) {
-        evtText = isPressed? "right-in" : "right-out";
-    }
-    else if (bottomPin_ && pin == bottomPin_) {
-        evtText = isPressed? "bottom-in" : "bottom-out";
-    }
-    else if (spreadPin_ && pin == spreadPin_) {
-        evtText = isPressed? "spread-in" : "spread-out";
-    }
-    
-    if (evtText != "") {
-        Report r;
-        r.mask = (1UL << pinIndex);
-        r.count = 1;
-        r.longPress = false;
-        r.text = evtText;
-        queueReport(r);
+    size_t len = 0;
+    for (uint8_t role = BUTTON_LEFT; role < BUTTON_ROLES && len < size; role++) {
+        if (!(r.chord & (1 << role))) continue;
+        len += snprintf(out + len, size - len, "%s-", ROLE_NAMES[role]);
     }
+    if (len < size) snprintf(out + len, size - len, "%s", EVENT_NAMES[r.event]);
 }
-
-String ButtonGroup::buildLabel(uint32_t mask, bool isLong) const {
-    int8_t left = leftPin_ ? findIndex(leftPin_) : -1;
-    int8_t right = rightPin_ ? findIndex(rightPin_) : -1;
-    int8_t bottom = bottomPin_ ? findIndex(bottomPin_) : -1;
-
-    uint8_t btnState = 0; // Renamed from 'mask' to 'btnState'
-    
-    // We check the input 'mask' (uint32_t) to see which buttons are active
-    if (left >= 0 && (mask & (1UL << left))) btnState |= 1;
-    if (right >= 0 && (mask & (1UL << right))) btnState |= 2;
-    if (bottom >= 0 && (mask & (1UL << bottom))) btnState |= 4;
-
-    switch (btnState) {
-        case 1: return String("left-") + (isLong ? "long" : "short");
-        case 2: return String("right-") + (isLong ? "long" : "short");
-        case 4: return String("bottom-") + (isLong ? "long" : "short");
-        case 1|2: return String("left-right-") + (isLong ? "long" : "short");
-        case 1|4: return String("left-bottom-") + (isLong ? "long" : "short");
-        case 2|4: return String("right-bottom-") + (isLong ? "long" : "short");
-        case 1|2|4: return String("left-right-bottom-") + (isLong ? "long" : "short");
-        default: return String("unknown");
-    }
-}
\ No newline at end of file
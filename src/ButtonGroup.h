@@ -2,17 +2,37 @@
 #define BUTTON_GROUP_H
 
 #include <Arduino.h>
+#include "SpscRing.h"
 
 #define MAX_BUTTONS 12
 #define REPORT_QUEUE_SIZE 8 
 
+// What each button is for; reports name buttons by role, not pin
+enum ButtonRole : uint8_t {
+    BUTTON_NONE,
+    BUTTON_LEFT,
+    BUTTON_RIGHT,
+    BUTTON_BOTTOM,
+    BUTTON_SPREAD,
+    BUTTON_ROLES
+};
+
+enum ButtonEvent : uint8_t {
+    BUTTON_PRESS,       // one button went down
+    BUTTON_RELEASE,     // ...and came back up
+    BUTTON_SHORT,       // a chord was let go without any long hold
+    BUTTON_LONG,        // a lone button passed long_ms, or a chord that held one
+    BUTTON_EVENTS
+};
+
 class ButtonGroup {
     public:
+        // Plain data, so queueing one is a copy of a few bytes
         struct Report {
-            uint32_t mask;
-            uint8_t count;
-            bool longPress;
-            String text;
+            ButtonEvent event;
+            ButtonRole role;    // the button, for PRESS and RELEASE
+            uint8_t chord;      // 1 << role for every button involved
+            uint32_t atMs;      // millis() when the event was detected
         };
         ButtonGroup(unsigned long debounce_ms = 50, unsigned long long_ms = 1000);
 
@@ -24,7 +44,11 @@ class ButtonGroup {
         void begin();
         void end();
         void service();
-        bool poll(Report &out);
+        // Consumer side of the report ring; service() is the producer
+        bool poll(Report &out) { return reports_.pop(out); }
+
+        // Debug text such as "left-in" or "left-right-short"
+        static void describe(const Report &r, char *out, size_t size);
 
         static void isr_handler();
 
@@ -35,14 +59,9 @@ class ButtonGroup {
         unsigned long longMs_;
 
         uint8_t pins_[MAX_BUTTONS];
+        ButtonRole roles_[MAX_BUTTONS];
         uint8_t count_ = 0;
 
-        // Role Pins
-        uint8_t leftPin_ = 0;
-        uint8_t rightPin_ = 0;
-        uint8_t bottomPin_ = 0;
-        uint8_t spreadPin_ = 0; // New role
-
         volatile uint32_t isrMask_ = 0;
         volatile bool isrChanged_ = false;
 
@@ -58,16 +77,13 @@ class ButtonGroup {
         bool sessionHasLong_ = false;
         uint32_t emittedLongMask_ = 0;
 
-        Report reportQueue_[REPORT_QUEUE_SIZE];
-        uint8_t qHead_ = 0;
-        uint8_t qTail_ = 0;
+        SpscRing<Report, REPORT_QUEUE_SIZE> reports_;
 
         int8_t findIndex(uint8_t pin) const;
-        void addIfMissing(uint8_t pin);
-        String buildLabel(uint32_t mask, bool isLong) const;
+        void addIfMissing(uint8_t pin, ButtonRole role);
+        uint8_t chordOf(uint32_t mask) const;
 
-        void queueReport(const Report &r);
-        void generateEdgeReport(uint8_t pinIndex, bool isPressed);
+        void queueReport(ButtonEvent event, ButtonRole role, uint8_t chord, unsigned long now);
 };
 
 #endif
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "Controller.h"
 #include "animation/helper.h"
+#include "PinnedTask.h"
 
 Controller::Controller(LGFX &lcd,
                        LGFX_Sprite *sp0,
@@ -8,7 +9,11 @@ Controller::Controller(LGFX &lcd,
                        Adafruit_NeoPixel &pixels)
     : lcd_(lcd),
       buttons_(buttons),
-      pixels_(pixels)
+      pixels_(pixels),
+      neoPixelBus_(pixels),
+      leds_(neoPixelBus_),
+      bus_(lcd),
+      transfers_(bus_)
 {
     sprites_[0] = sp0;
     sprites_[1] = sp1;
@@ -17,99 +22,216 @@ Controller::Controller(LGFX &lcd,
 void Controller::begin() {
     lcd_.begin();
     lcd_.setColorDepth(16);
-    srand(esp_random()); 
+
+    // Everything random in the pond derives from this seed. Draws are kept
+    // in separate statements: argument evaluation order is unspecified, and
+    // host and device must consume the stream identically.
+    if (!hasSeed_) seed_ = esp_random();
+    Random sceneRandom(seed_);
+    rippleRandom_.reseed(sceneRandom.fork());
 
     if (lcd_.width() < lcd_.height()) lcd_.setRotation(lcd_.getRotation() ^ 1);
 
+    // diffDraw() compares four indexed pixels at a time, so rows must be
+    // whole 32-bit words
+    palette_.begin(indexedColor_ && !bandRendering_ && lcd_.width() % 4 == 0);
+    for (int b = 0; b < 256; b++) rippleInk_[b] = palette_.ink(lcd_.color565(b, b, b));
+    profiler_.setHudInk(palette_.ink(TFT_YELLOW));
+
+    int spriteHeight = bandRendering_ ? BAND_HEIGHT : lcd_.height();
     for (auto& sprite : sprites_) {
-        sprite->setColorDepth(16); 
-        sprite->createSprite(lcd_.width(), lcd_.height());
+        if (palette_.indexed()) sprite->setColorDepth(lgfx::palette_8bit);
+        else sprite->setColorDepth(16);
+        sprite->createSprite(lcd_.width(), spriteHeight);
         sprite->setSwapBytes(true);
         sprite->fillScreen(0); 
     }
 
+    transfers_.begin();
+    if (pushTask_) transfers_.startPushTask(PUSH_CORE);
+
+    retiredRegion_.setBounds(lcd_.width(), lcd_.height());
+    ticksChanged_.setBounds(lcd_.width(), lcd_.height());
+    lastChanged_.setBounds(lcd_.width(), lcd_.height());
+    redrawRegion_.setBounds(lcd_.width(), lcd_.height());
+    leafGrid_.setBounds(lcd_.width(), lcd_.height());
+    duckWeedGrid_.setBounds(lcd_.width(), lcd_.height());
+
     buttons_.begin();
 
-    pixels_.begin();
-    pixels_.setBrightness(60);
-    pixels_.show();
+    leds_.setBrightness(LED_BRIGHTNESS);
+    leds_.begin(pixels_.numPixels());
+    transfers_.pump();
 
     int w = lcd_.width();
     int h = lcd_.height();
 
-    int numFish = 5;
-    fishes_.clear();
-    uint16_t fishFill = lcd_.color565(29, 29, 29); 
-    uint16_t fishStroke = lcd_.color565(155, 155, 155);
+    int numFish = numFishes_;
+    scene_.fishes.clear();
+    scene_.fishes.reserve(numFish);
 
     for (int i=0; i<numFish; i++) {
-        float fishSize = sqrt(pow(w, 2) + pow(h, 2)) * 0.015f * randomFloat(0.8f, 1.2f);
-        float fishLength = fishSize * randomFloat(6.0f, 8.5f); 
-        float fishWidth = fishLength * randomFloat(0.24f, 0.28f);
-        int posX = random(0, w);
-        int posY = random(0, h);
-        fishes_.emplace_back(posX, posY, fishLength, fishWidth, w, h, fishFill, fishStroke);
-    }
-
-    int numLeaves = 15;
-    leaves_.clear();
-    uint16_t leafFill = lcd_.color565(62, 145, 60); 
-    uint16_t leafStroke = lcd_.color565(0, 0, 0); 
+        const FishSpecies &species = *species_[i % speciesCount_];
+        uint16_t fishFill = palette_.ink(lcd_.color565(species.fillColor >> 16, species.fillColor >> 8 & 0xFF, species.fillColor & 0xFF));
+        uint16_t fishStroke = palette_.ink(lcd_.color565(species.strokeColor >> 16, species.strokeColor >> 8 & 0xFF, species.strokeColor & 0xFF));
+
+        float fishSize = sqrt(pow(w, 2) + pow(h, 2)) * 0.015f * sceneRandom.range(0.8f, 1.2f);
+        float fishLength = fishSize * sceneRandom.range(species.minLength, species.maxLength); 
+        float fishWidth = fishLength * sceneRandom.range(species.minWidthRatio, species.maxWidthRatio);
+        int posX = sceneRandom.below(w);
+        int posY = sceneRandom.below(h);
+        scene_.fishes.emplace_back(species, posX, posY, fishLength, fishWidth, w, h, sceneRandom, fishFill, fishStroke, palette_.ink(TFT_DARKGREY));
+    }
+
+    int numLeaves = numLeaves_;
+    scene_.leaves.clear();
+    uint16_t leafFill = palette_.ink(lcd_.color565(62, 145, 60)); 
+    uint16_t leafStroke = palette_.ink(lcd_.color565(0, 0, 0)); 
     int segments = 16;
 
     for(int i=0; i<numLeaves; i++) {
         float size = sqrt(pow(w, 2) + pow(h, 2)) * 1.2f;
-        float radius = randomFloat(size * 0.02f, size * 0.05f);
-        leaves_.emplace_back(randomFloat(0, w), randomFloat(0, h), radius, segments, leafFill, leafStroke);
+        float radius = sceneRandom.range(size * 0.02f, size * 0.05f);
+        float x = sceneRandom.range(0, w);
+        float y = sceneRandom.range(0, h);
+        scene_.leaves.emplace_back(x, y, radius, segments, sceneRandom, leafFill, leafStroke);
     }
 
-    int numDuckWeeds = 50;
-    duckWeeds_.clear();
+    int numDuckWeeds = targetDuckWeeds();
     uint16_t weedFill = lcd_.color565(62, 145, 60);
     uint16_t weedStroke = lcd_.color565(0, 0, 0);
+    float weedSize = sqrt(pow(w, 2)+ pow(h, 2));
+    scene_.duckWeeds.begin(weedSize * 0.001f, weedSize * 0.01f, weedFill, weedStroke, sceneRandom.fork(), palette_);
+    scene_.duckWeeds.clear();
+    scene_.duckWeeds.reserve(maxDuckWeeds_);
 
     for(int i=0; i<numDuckWeeds; i++) {
-        float size = sqrt(pow(w, 2)+ pow(h, 2));
-        float radius = randomFloat(size * 0.001f, size * 0.01f);
-        duckWeeds_.emplace_back(randomFloat(0, w), randomFloat(0, h), radius, 4, weedFill, weedStroke);
+        float radius = sceneRandom.range(weedSize * 0.001f, weedSize * 0.01f);
+        float x = sceneRandom.range(0, w);
+        float y = sceneRandom.range(0, h);
+        scene_.duckWeeds.add(x, y, radius);
     }
     
-    rippleCooldown_ = (unsigned long)randomFloat(2000, 7000);
-    lastRippleTime_ = millis();
+    scene_.entityRects.reserve(scene_.entityCapacity());
+    // The panel starts black, as if showing an empty scene
+    if (bandRendering_) reserveScene(shownScene_);
+
+    rippleCooldown_ = nextRippleCooldown();
+    lastRippleTime_ = simMillis_;
+    simClock_.start();
+}
+
+void Controller::setTargetFps(int fps, int minDuckWeeds, int maxDuckWeeds) {
+    governor_.setTargetFps(fps);
+    minDuckWeeds_ = minDuckWeeds;
+    maxDuckWeeds_ = maxDuckWeeds > minDuckWeeds ? maxDuckWeeds : minDuckWeeds;
+    // Growing past the reserve allocates once, here rather than mid-frame
+    scene_.duckWeeds.reserve(maxDuckWeeds_);
+    scene_.entityRects.reserve(scene_.entityCapacity());
+    if (bandRendering_) reserveScene(shownScene_);
+}
+
+void Controller::reserveScene(Scene &scene) const {
+    scene.fishes.reserve(scene_.fishes.size());
+    scene.leaves.reserve(scene_.leaves.size());
+    scene.duckWeeds.reserve(scene_.duckWeeds.capacity());
+    scene.entityRects.reserve(scene_.entityCapacity());
+}
+
+Controller::Density Controller::density() const {
+    return {governor_.level(), scene_.duckWeeds.alive(), (int)scene_.ripples.size(),
+            rippleStretch(), rippleIntensity(), governor_.frameMicros()};
+}
+
+int Controller::targetDuckWeeds() const {
+    return minDuckWeeds_ + (maxDuckWeeds_ - minDuckWeeds_) * governor_.level() / GOVERNOR_LEVELS;
+}
+
+float Controller::rippleStretch() const {
+    int sparseness = GOVERNOR_LEVELS - governor_.level();
+    return 1.0f + (SPARSE_RIPPLE_STRETCH - 1.0f) * sparseness / GOVERNOR_LEVELS;
 }
 
+float Controller::rippleIntensity() const {
+    int sparseness = GOVERNOR_LEVELS - governor_.level();
+    return rippleIntensity_ * (1.0f - (1.0f - SPARSE_RIPPLE_INTENSITY) * sparseness / GOVERNOR_LEVELS);
+}
+
+unsigned long Controller::nextRippleCooldown() {
+    return (unsigned long)(rippleRandom_.range(rippleMinMs_, rippleMaxMs_) * rippleStretch());
+}
+
+void Controller::recordRender(uint32_t micros) {
+    renderMicros_.store(micros, std::memory_order_relaxed);
+    renderedFrames_.fetch_add(1, std::memory_order_release);
+}
+
+void Controller::updateFishDetail() {
+    // Several ticks can run per rendered frame; each frame's cost counts once
+    uint32_t frames = renderedFrames_.load(std::memory_order_acquire);
+    if (frames == budgetedFrames_) return;
+    budgetedFrames_ = frames;
+    fishDetail_.update(renderMicros_.load(std::memory_order_relaxed), scene_.fishes);
+}
+
+void Controller::applyDensity() {
+    // Retire in one go but fade in gradually, so a busy scene sheds load fast
+    int missing = targetDuckWeeds() - scene_.duckWeeds.alive();
+    if (missing < 0) {
+        scene_.duckWeeds.retire(-missing);
+    } else {
+        int room = scene_.duckWeeds.capacity() - scene_.duckWeeds.size();
+        if (missing > room) missing = room;
+        if (missing > DENSITY_SPAWNS_PER_TICK) missing = DENSITY_SPAWNS_PER_TICK;
+        for (int i = 0; i < missing; i++) scene_.duckWeeds.spawn(lcd_.width(), lcd_.height());
+    }
+}
+
+// Press and release go to the button's handler; chord gestures are unused
+const Controller::InputHandler Controller::INPUT_HANDLERS[BUTTON_EVENTS][BUTTON_ROLES] = {
+    /* BUTTON_PRESS */   {nullptr, &Controller::onLeftButton, &Controller::onRightButton,
+                          &Controller::onBottomButton, &Controller::onSpreadButton},
+    /* BUTTON_RELEASE */ {nullptr, &Controller::onLeftButton, &Controller::onRightButton,
+                          &Controller::onBottomButton, &Controller::onSpreadButton},
+    /* BUTTON_SHORT */   {},
+    /* BUTTON_LONG */    {},
+};
+
 void Controller::handleReport(const ButtonGroup::Report &rep) {
-    String txt = rep.text;
-    
-    if (txt == "left-in") {
-        swimTopLeft_ = true;
-    } else if (txt == "left-out") {
-        swimTopLeft_ = false;
-    } else if (txt == "right-in") {
-        swimTopRight_ = true;
-    } else if (txt == "right-out") {
-        swimTopRight_ = false;
-    } else if (txt == "bottom-in") {
-        swimBottomCenter_ = true;
-    } else if (txt == "bottom-out") {
-        swimBottomCenter_ = false;
-    } else if (txt == "spread-in") {
-        spreadHolding_ = true;
-        // Trigger dashing away
-        if (!fishes_.empty()) {
-             float sumX = 0, sumY = 0;
-             for(auto& f : fishes_) { Point p = f.getPosition(); sumX += p.x; sumY += p.y; }
-             float avgX = sumX / fishes_.size();
-             float avgY = sumY / fishes_.size();
-             
-             for(auto& f : fishes_) {
-                 Point p = f.getPosition();
-                 float angle = atan2(p.y - avgY, p.x - avgX);
-                 f.triggerDash(angle);
-             }
-        }
-    } else if (txt == "spread-out") {
-        spreadHolding_ = false;
+    if (rep.event >= BUTTON_EVENTS || rep.role >= BUTTON_ROLES) return;
+    InputHandler handler = INPUT_HANDLERS[rep.event][rep.role];
+    if (handler) (this->*handler)(rep);
+}
+
+void Controller::onLeftButton(const ButtonGroup::Report &rep) {
+    swimTopLeft_ = rep.event == BUTTON_PRESS;
+}
+
+void Controller::onRightButton(const ButtonGroup::Report &rep) {
+    swimTopRight_ = rep.event == BUTTON_PRESS;
+}
+
+void Controller::onBottomButton(const ButtonGroup::Report &rep) {
+    swimBottomCenter_ = rep.event == BUTTON_PRESS;
+}
+
+void Controller::onSpreadButton(const ButtonGroup::Report &rep) {
+    spreadHolding_ = rep.event == BUTTON_PRESS;
+    if (!spreadHolding_) return;
+    leds_.pulse(0xFF, LED_DASH_COLOR, LED_DASH_PULSE_MS);
+
+    // Trigger dashing away
+    if (!scene_.fishes.empty()) {
+         float sumX = 0, sumY = 0;
+         for(auto& f : scene_.fishes) { Point p = f.getPosition(); sumX += p.x; sumY += p.y; }
+         float avgX = sumX / scene_.fishes.size();
+         float avgY = sumY / scene_.fishes.size();
+         
+         for(auto& f : scene_.fishes) {
+             Point p = f.getPosition();
+             float angle = atan2(p.y - avgY, p.x - avgX);
+             f.triggerDash(angle);
+         }
     }
 }
 
@@ -121,131 +243,263 @@ static bool isOverlapping(const FishBounds& a, const FishBounds& b) {
 }
 
 void Controller::detectFishFishCollision() {
-    for (size_t i = 0; i < fishes_.size(); i++) {
-        if (!fishes_[i].getIsDashing()) continue;
+    for (size_t i = 0; i < scene_.fishes.size(); i++) {
+        if (!scene_.fishes[i].getIsDashing()) continue;
         
-        FishBounds b1 = fishes_[i].getBounds();
+        FishBounds b1 = scene_.fishes[i].getBounds();
         
-        for (size_t j = 0; j < fishes_.size(); j++) {
+        for (size_t j = 0; j < scene_.fishes.size(); j++) {
             if (i == j) continue;
-            FishBounds b2 = fishes_[j].getBounds();
+            FishBounds b2 = scene_.fishes[j].getBounds();
             if (isOverlapping(b1, b2)) {
-                fishes_[j].triggerDash();
+                scene_.fishes[j].triggerDash();
             }
         }
     }
 }
 
+void Controller::indexPlants() {
+    leafGrid_.clear();
+    for (const auto& leaf : scene_.leaves) {
+        Point p = leaf.getPosition();
+        leafGrid_.add(p.x, p.y, leaf.getRadius());
+    }
+    leafGrid_.build();
+
+    duckWeedGrid_.clear();
+    const DuckWeedField &weeds = scene_.duckWeeds;
+    for (int i = 0; i < weeds.size(); i++) {
+        Point p = weeds.getPosition(i);
+        duckWeedGrid_.add(p.x, p.y, weeds.getRadius(i));
+    }
+    duckWeedGrid_.build();
+}
+
 void Controller::detectFishLeafCollision() {
-    if(fishes_.empty()) return;
-    for (auto& fish : fishes_) {
+    if(scene_.fishes.empty()) return;
+    for (auto& fish : scene_.fishes) {
         Point fishP = fish.getPosition(); 
         float fishVel = fish.getVelocity(); 
         float fishWidth = fish.getWidth();
+        float reachSq = fishWidth * fishWidth * 4.0f;
 
-        for (auto& leaf : leaves_) {
+        leafGrid_.query(fishP.x, fishP.y, fishWidth * 2.0f, [&](int i) {
+            Leaf& leaf = scene_.leaves[i];
             Point leafP = leaf.getPosition();
-            float d = dist(fishP.x, fishP.y, leafP.x, leafP.y);
-            if (d >= fishWidth * 2.0f || d == 0) continue; 
+            float dSq = distSq(fishP.x, fishP.y, leafP.x, leafP.y);
+            if (dSq >= reachSq || dSq == 0) return;
+            float d = mathSqrt(dSq);
             leaf.applyOscillation(fishP.x, fishP.y, fishVel / d * 2.0f);
-        }
+        });
     }
 }
 
 void Controller::detectFishDuckWeedCollision() {
-    if(fishes_.empty()) return;
-    for (auto& fish : fishes_) {
+    if(scene_.fishes.empty()) return;
+    for (auto& fish : scene_.fishes) {
         Point fishP = fish.getPosition(); 
         float fishVel = fish.getVelocity(); 
         float fishWidth = fish.getWidth();
+        float reachSq = fishWidth * fishWidth * 4.0f;
+
+        duckWeedGrid_.query(fishP.x, fishP.y, fishWidth * 2.0f, [&](int i) {
+            Point dwP = scene_.duckWeeds.getPosition(i);
+            float dSq = distSq(fishP.x, fishP.y, dwP.x, dwP.y);
+            if (dSq >= reachSq || dSq == 0) return;
+            float d = mathSqrt(dSq);
+            scene_.duckWeeds.applyVector(i, fishP.x, fishP.y, (0.2f * fishVel) / d);
+        });
+    }
+}
 
-        for (auto& dw : duckWeeds_) {
-            Point dwP = dw.getPosition();
-            float d = dist(fishP.x, fishP.y, dwP.x, dwP.y);
-            if (d >= fishWidth * 2.0f || d == 0) continue;
-            dw.applyVector(fishP.x, fishP.y, (0.2f * fishVel) / d);
+// Applies every ring of every ripple to the plants inside its band. The grid
+// cells around a ripple are visited once; only the rings whose band reaches a
+// cell are tested against its plants, so the work follows the actual hits.
+// Per plant the rings are still applied in ripple order, then ring order.
+static Point plantPosition(const std::vector<Leaf> &leaves, int i) { return leaves[i].getPosition(); }
+static float plantRadius(const std::vector<Leaf> &leaves, int i) { return leaves[i].getRadius(); }
+static Point plantPosition(const DuckWeedField &weeds, int i) { return weeds.getPosition(i); }
+static float plantRadius(const DuckWeedField &weeds, int i) { return weeds.getRadius(i); }
+
+template <typename Plants, typename Apply>
+static void detectRipplePlantCollision(const RipplePool &ripples,
+                                       const Plants &plants,
+                                       const SpatialGrid &grid,
+                                       float magnitude, Apply apply) {
+    float pad = grid.maxRadius();
+    for (const auto& r : ripples) {
+        const RippleRings &rings = r.getRings();
+        float outer = 0;
+        for (const auto& ring : rings) outer = fmaxf(outer, ring.currentRadius);
+        float x = r.getX();
+        float y = r.getY();
+
+        // Rings are handled 32 at a time so a cell can flag them in one mask
+        for (size_t base = 0; base < rings.size(); base += 32) {
+            size_t count = rings.size() - base < 32 ? rings.size() - base : 32;
+            grid.queryCells(x, y, outer + pad, [&](float nearestSq, float farthestSq, const uint32_t *first, const uint32_t *last) {
+                uint32_t reaching = 0;
+                for (size_t k = 0; k < count; k++) {
+                    float radius = rings[base + k].currentRadius;
+                    float reach = radius + pad;
+                    float hollow = radius - pad;
+                    if (reach * reach < nearestSq) continue;
+                    if (hollow > 0 && hollow * hollow > farthestSq) continue;
+                    reaching |= 1u << k;
+                }
+                if (!reaching) return;
+
+                for (const uint32_t *it = first; it != last; it++) {
+                    int i = *it;
+                    Point p = plantPosition(plants, i);
+                    float dSq = distSq(x, y, p.x, p.y);
+                    float radius = plantRadius(plants, i);
+                    for (size_t k = 0; k < count; k++) {
+                        if (!(reaching & (1u << k))) continue;
+                        const RippleRing &ring = rings[base + k];
+                        // The plant must overlap the ring's line
+                        float reach = ring.currentRadius + radius;
+                        float hollow = ring.currentRadius - radius;
+                        if (dSq > reach * reach) continue;
+                        if (hollow > 0 && dSq < hollow * hollow) continue;
+                        float mag = map(ring.currentIntensity, 0, 100, 0, magnitude);
+                        apply(i, x, y, mag);
+                    }
+                }
+            });
         }
     }
 }
 
 void Controller::detectRippleLeafCollision() {
-    for (const auto& r : ripples_) {
-        for (auto& leaf : leaves_) {
-            Point lPos = leaf.getPosition();
-            float d = dist(r.getX(), r.getY(), lPos.x, lPos.y);
-            
-            for (const auto& ring : r.getRings()) {
-                float radius = ring.currentRadius;
-                if (d > radius + leaf.getRadius()) continue;
-                if (d < radius - leaf.getRadius()) continue;
-                float mag = map(ring.currentIntensity, 0, 100, 0, 5.0f);
-                leaf.applyOscillation(r.getX(), r.getY(), mag);
-            }
-        }
-    }
+    detectRipplePlantCollision(scene_.ripples, scene_.leaves, leafGrid_, 5.0f,
+        [&](int i, float x, float y, float mag) { scene_.leaves[i].applyOscillation(x, y, mag); });
 }
 
 void Controller::detectRippleDuckWeedCollision() {
-    for (const auto& r : ripples_) {
-        for (auto& dw : duckWeeds_) {
-            Point dwPos = dw.getPosition();
-            float d = dist(r.getX(), r.getY(), dwPos.x, dwPos.y);
-            
-            for (const auto& ring : r.getRings()) {
-                float radius = ring.currentRadius;
-                if (d > radius + dw.getRadius()) continue;
-                if (d < radius - dw.getRadius()) continue;
-                float mag = map(ring.currentIntensity, 0, 100, 0, 0.1f);
-                dw.applyVector(r.getX(), r.getY(), mag);
-            }
+    detectRipplePlantCollision(scene_.ripples, scene_.duckWeeds, duckWeedGrid_, 0.1f,
+        [&](int i, float x, float y, float mag) { scene_.duckWeeds.applyVector(i, x, y, mag); });
+}
+
+// Calls emit(x, y, len, pixels) for each run of row pixels in area where cur
+// differs from prev. Pixels are compared a 32-bit word at a time, so rows
+// must be word aligned.
+template <typename Pixel, typename Emit>
+static void diffSpans(const Pixel *cur, const Pixel *prev, int width, const Rect &area, Emit emit) {
+    const int perWord = 4 / sizeof(Pixel);
+
+    // Widen the span to whole words
+    int xFrom = area.left & ~(perWord - 1);
+    int xTo = (area.right + perWord - 1) & ~(perWord - 1);
+    if (xTo > width) xTo = width;
+    int wordFrom = xFrom / perWord;
+    int wordTo = xTo / perWord;
+
+    cur += area.top * width;
+    prev += area.top * width;
+    for (int y = area.top; y < area.bottom; y++, cur += width, prev += width) {
+        const uint32_t* cur32 = (const uint32_t*)cur;
+        const uint32_t* prev32 = (const uint32_t*)prev;
+        int word = wordFrom;
+        while (word < wordTo) {
+            while (word < wordTo && cur32[word] == prev32[word]) word++;
+            if (word >= wordTo) break;
+            // Trim unchanged pixels off both ends; the end words differ, so
+            // neither trim leaves its word
+            int xStart = word * perWord;
+            while (cur[xStart] == prev[xStart]) xStart++;
+            while (word < wordTo && cur32[word] != prev32[word]) word++;
+            int lastWord = (word - 1) * perWord;
+            int xEnd = word * perWord - 1;
+            if (xEnd >= width) xEnd = width - 1;
+            while (xEnd > xStart && xEnd > lastWord && cur[xEnd] == prev[xEnd]) xEnd--;
+            int len = xEnd - xStart + 1;
+            if (len > 0) emit(xStart, y, len, &cur[xStart]);
         }
     }
 }
 
-void Controller::diffDraw(LGFX_Sprite* sp0, LGFX_Sprite* sp1) {
+// Queues the spans of sp0 that differ from sp1; sp0 must stay untouched
+// until transfers_.fence(source) returns.
+void Controller::diffDraw(uint8_t source, LGFX_Sprite* sp0, LGFX_Sprite* sp1, const Rect &area) {
     if (!sp0 || !sp1) return;
-    uint16_t* s16 = (uint16_t*)sp0->getBuffer();
-    uint16_t* p16 = (uint16_t*)sp1->getBuffer();
-    uint32_t* s32 = (uint32_t*)s16;
-    uint32_t* p32 = (uint32_t*)p16;
-
     int width = sp0->width();
-    int height = sp0->height();
-    int w32 = width >> 1; 
-
-    for (int y = 0; y < height; y++) {
-        int x32 = 0;
-        while (x32 < w32) {
-            while (x32 < w32 && s32[x32] == p32[x32]) x32++;
-            if (x32 >= w32) break; 
-            int x_start = x32 << 1; 
-            if (s16[x_start] == p16[x_start]) x_start++;
-            while (x32 < w32 && s32[x32] != p32[x32]) x32++;
-            int x_end = (x32 << 1) - 1; 
-            if (x_end >= width) x_end = width - 1;
-            if (x_end > x_start && s16[x_end] == p16[x_end]) x_end--;
-            int len = x_end - x_start + 1;
-            if (len > 0) {
-                lcd_.pushImage(x_start, y, len, 1, &s16[x_start]);
-            }
+
+    if (palette_.indexed()) {
+        diffSpans((const uint8_t*)sp0->getBuffer(), (const uint8_t*)sp1->getBuffer(), width, area,
+            [&](int x, int y, int len, const uint8_t *pixels) { transfers_.enqueue(source, x, y, len, pixels, palette_); });
+    } else {
+        diffSpans((const uint16_t*)sp0->getBuffer(), (const uint16_t*)sp1->getBuffer(), width, area,
+            [&](int x, int y, int len, const uint16_t *pixels) { transfers_.enqueue(source, x, y, len, pixels); });
+    }
+}
+
+template <typename Entities>
+static void trackEntities(Entities& entities, std::vector<Rect>& rects, DirtyRegion& changed) {
+    Rect previous, current;
+    for (auto& e : entities) {
+        if (e.trackDirty(previous, current)) {
+            changed.add(previous);
+            changed.add(current);
         }
-        s16 += width;
-        p16 += width;
-        s32 = (uint32_t*)s16;
-        p32 = (uint32_t*)p16;
+        rects.push_back(current);
     }
 }
 
-void Controller::drawfunc(void) {
-    if (!sprites_[0] || !sprites_[1] || fishes_.empty()) return;
+static void trackEntities(DuckWeedField& weeds, std::vector<Rect>& rects, DirtyRegion& changed) {
+    Rect previous, current;
+    for (int i = 0; i < weeds.size(); i++) {
+        if (weeds.trackDirty(i, previous, current)) {
+            changed.add(previous);
+            changed.add(current);
+        }
+        rects.push_back(current);
+    }
+}
 
-    std::size_t flip = _draw_count & 1;
-    LGFX_Sprite* currentSprite = sprites_[flip];
-    LGFX_Sprite* prevSprite = sprites_[!flip];
-    currentSprite->fillScreen(0);
+void Controller::trackScene() {
+    scene_.changed = retiredRegion_;
+    retiredRegion_.clear();
+
+    scene_.entityRects.clear();
+    trackEntities(scene_.fishes, scene_.entityRects, scene_.changed);
+    trackEntities(scene_.duckWeeds, scene_.entityRects, scene_.changed);
+    trackEntities(scene_.ripples, scene_.entityRects, scene_.changed);
+    trackEntities(scene_.leaves, scene_.entityRects, scene_.changed);
+}
+
+void Controller::pumpTransfers() {
+    // In pipelined mode the queue belongs to the render task; with a push
+    // task this does nothing
+    if (!pipelined_) transfers_.pump();
+}
+
+void Controller::drawEntities(Scene &scene, LGFX_Sprite* sprite, const Rect *clip) {
+    // Same order as Scene::entityRects
+    std::size_t i = 0;
+    for (auto& fish : scene.fishes) {
+        if (!clip || intersects(*clip, scene.entityRects[i])) fish.draw(sprite);
+        i++;
+    }
+    for (int d = 0; d < scene.duckWeeds.size(); d++) {
+        if (!clip || intersects(*clip, scene.entityRects[i])) scene.duckWeeds.draw(d, sprite);
+        i++;
+    }
+    for (auto& r : scene.ripples) {
+        if (!clip || intersects(*clip, scene.entityRects[i])) r.draw(sprite, rippleInk_);
+        i++;
+    }
+    for (auto& l : scene.leaves) {
+        if (!clip || intersects(*clip, scene.entityRects[i])) l.draw(sprite);
+        i++;
+    }
+}
+
+void Controller::simulate() {
+    ProfileLap lap(profiler_);
 
     // 1. Update LEDs based on current flags
-    uint32_t color = pixels_.Color(62, 145, 60);
+    uint32_t color = LED_SWIM_COLOR;
     
     // Reset all to 0 first
     uint32_t c0 = 0, c1 = 0, c2 = 0;
@@ -257,45 +511,53 @@ void Controller::drawfunc(void) {
         if (swimTopRight_) c2 = color;
         if (swimBottomCenter_) c1 = color;
     }
-    pixels_.setPixelColor(0, c0);
-    pixels_.setPixelColor(1, c1);
-    pixels_.setPixelColor(2, c2);
-    pixels_.show();
+    leds_.setTarget(0, c0);
+    leds_.setTarget(1, c1);
+    leds_.setTarget(2, c2);
+    leds_.update(simMillis_);
+    leds_.pump();
+    pumpTransfers();
+    lap.mark(PROFILE_LEDS);
 
     // 2. Spawn Ripples
-    unsigned long now = millis();
+    simMillis_ += SIM_TICK_MS;
+    unsigned long now = simMillis_;
     if (now - lastRippleTime_ >= rippleCooldown_) {
-        float rx = randomFloat(0, lcd_.width());
-        float ry = randomFloat(0, lcd_.height());
-        ripples_.emplace_back(rx, ry, rippleIntensity_); 
+        float rx = rippleRandom_.range(0, lcd_.width());
+        float ry = rippleRandom_.range(0, lcd_.height());
+        scene_.ripples.emplace_back(rx, ry, rippleIntensity());
+        int nearest = (int)(rx * leds_.count() / lcd_.width());
+        leds_.pulse(1 << nearest, LED_RIPPLE_COLOR, LED_RIPPLE_PULSE_MS);
         lastRippleTime_ = now;
-        rippleCooldown_ = (unsigned long)randomFloat(2000, 7000);
+        rippleCooldown_ = nextRippleCooldown();
     }
 
     // 3. Update & Bounce Ripples
     bool bounceEnabled = false;
-    std::vector<Ripple> bouncedRipples;
-    for (int i = ripples_.size() - 1; i >= 0; i--) {
-        bool alive = ripples_[i].update();
+    bouncedRipples_.clear();
+    for (int i = scene_.ripples.size() - 1; i >= 0; i--) {
+        bool alive = scene_.ripples[i].update(SIM_TICK_MS);
         if (bounceEnabled) {
-            std::vector<Ripple> newR = ripples_[i].detectBouncing(lcd_.width(), lcd_.height());
-            bouncedRipples.insert(bouncedRipples.end(), newR.begin(), newR.end());
+            scene_.ripples[i].detectBouncing(lcd_.width(), lcd_.height(), bouncedRipples_);
+        }
+        if (!alive) {
+            retiredRegion_.add(scene_.ripples[i].getDrawnRect());
         }
-        if (!alive) ripples_.erase(ripples_.begin() + i);
     }
-    if (bounceEnabled) ripples_.insert(ripples_.end(), bouncedRipples.begin(), bouncedRipples.end());
+    // A ripple dies once its last ring has faded
+    scene_.ripples.removeIf([](const Ripple &r) { return r.getRings().empty(); });
+    if (bounceEnabled) scene_.ripples.append(bouncedRipples_);
+    pumpTransfers();
+    lap.mark(PROFILE_RIPPLES);
 
     // 4. Swimming Logic
-    // Pre-calculate directional vectors
-    float invSqrt2 = 0.70710678f; // 1 / sqrt(2)
-
     if (swimTopLeft_) {
         // Target: (0, 0)
-        for(auto& f : fishes_) {
+        for(auto& f : scene_.fishes) {
             Point p = f.getPosition();
             float dx = 0 - p.x;
             float dy = 0 - p.y;
-            float mag = sqrt(dx*dx + dy*dy);
+            float mag = mathSqrt(dx*dx + dy*dy);
             if (mag > 0.1f) {
                 float s = f.getSwimSpeed();
                 f.swim((dx / mag) * s, (dy / mag) * s);
@@ -305,11 +567,11 @@ void Controller::drawfunc(void) {
     if (swimTopRight_) {
         // Target: (width, 0)
         float targetX = lcd_.width();
-        for(auto& f : fishes_) {
+        for(auto& f : scene_.fishes) {
             Point p = f.getPosition();
             float dx = targetX - p.x;
             float dy = 0 - p.y;
-            float mag = sqrt(dx*dx + dy*dy);
+            float mag = mathSqrt(dx*dx + dy*dy);
             if (mag > 0.1f) {
                 float s = f.getSwimSpeed();
                 f.swim((dx / mag) * s, (dy / mag) * s);
@@ -319,11 +581,11 @@ void Controller::drawfunc(void) {
     if (swimBottomCenter_) {
         float targetX = lcd_.width() / 2.0f;
         float targetY = lcd_.height();
-        for(auto& f : fishes_) {
+        for(auto& f : scene_.fishes) {
             Point p = f.getPosition();
             float dx = targetX - p.x;
             float dy = targetY - p.y;
-            float mag = sqrt(dx*dx + dy*dy);
+            float mag = mathSqrt(dx*dx + dy*dy);
             if (mag > 0.1f) {
                 float s = f.getSwimSpeed();
                 f.swim((dx / mag) * s, (dy / mag) * s);
@@ -331,26 +593,169 @@ void Controller::drawfunc(void) {
         }
     }
 
+    lap.mark(PROFILE_SWIM);
+
     // Physics
-    for (auto& fish : fishes_) fish.update(lcd_.width(), lcd_.height());
-    for(auto& l : leaves_) l.update();
-    for(auto& d : duckWeeds_) d.update(lcd_.width(), lcd_.height());
+    applyDensity();
+    for (auto& fish : scene_.fishes) fish.update(lcd_.width(), lcd_.height());
+    for(auto& l : scene_.leaves) l.update();
+    scene_.duckWeeds.update(lcd_.width(), lcd_.height());
+    updateFishDetail();
+    pumpTransfers();
+    lap.mark(PROFILE_PHYSICS);
 
     // Collisions
+    indexPlants();
     detectFishLeafCollision();
     detectFishDuckWeedCollision();
+    pumpTransfers();
     detectRippleLeafCollision();
     detectRippleDuckWeedCollision();
     detectFishFishCollision(); 
+    pumpTransfers();
+    lap.mark(PROFILE_COLLISIONS);
 
-    // Draw
-    for (auto& fish : fishes_) fish.draw(currentSprite);
-    for(auto& d : duckWeeds_) d.draw(currentSprite);
-    for(auto& r : ripples_) r.draw(currentSprite);
-    for(auto& l : leaves_) l.draw(currentSprite);
+    trackScene();
+    lap.mark(PROFILE_TRACK);
+    profiler_.commitTick();
+}
 
-    diffDraw(currentSprite, prevSprite);
+void Controller::render(Scene &scene) {
+    if (!sprites_[0] || !sprites_[1] || scene.fishes.empty()) return;
+
+    if (bandRendering_) {
+        renderBands(scene);
+        transfers_.pump();
+        ++_draw_count;
+        finishFrame();
+        return;
+    }
+
+    std::size_t flip = _draw_count & 1;
+    LGFX_Sprite* currentSprite = sprites_[flip];
+    LGFX_Sprite* prevSprite = sprites_[!flip];
+
+    // Draw, once DMA is done reading what this sprite held two frames ago
+    ProfileLap lap(profiler_);
+    transfers_.fence(flip);
+    lap.mark(PROFILE_FENCE);
+    redrawRegion_ = scene.changed;
+    redrawRegion_.add(lastChanged_);
+    // The HUD is repainted every frame, on top of whatever lies beneath it
+    redrawRegion_.add(profiler_.hudRect());
+    lastChanged_ = scene.changed;
+
+    int w = currentSprite->width();
+    int h = currentSprite->height();
+
+    // Once most of the screen is dirty the per-rect bookkeeping stops paying off
+    if (!dirtyRects_ || redrawRegion_.area() * 4 > w * h * 3) {
+        currentSprite->fillScreen(0);
+        drawEntities(scene, currentSprite, nullptr);
+        profiler_.drawHud(currentSprite);
+        lap.mark(PROFILE_DRAW);
+        diffDraw(flip, currentSprite, prevSprite, {0, 0, w, h});
+    } else {
+        for (int i = 0; i < redrawRegion_.size(); i++) {
+            const Rect& r = redrawRegion_[i];
+            currentSprite->setClipRect(r.left, r.top, r.right - r.left, r.bottom - r.top);
+            currentSprite->fillRect(r.left, r.top, r.right - r.left, r.bottom - r.top, 0);
+            drawEntities(scene, currentSprite, &r);
+            if (intersects(r, profiler_.hudRect())) profiler_.drawHud(currentSprite);
+        }
+        currentSprite->clearClipRect();
+        lap.mark(PROFILE_DRAW);
+        for (int i = 0; i < redrawRegion_.size(); i++) {
+            diffDraw(flip, currentSprite, prevSprite, redrawRegion_[i]);
+        }
+    }
+    transfers_.pump();
+    lap.mark(PROFILE_DIFF);
     ++_draw_count;
+    finishFrame();
+}
+
+void Controller::finishFrame() {
+    profiler_.commitFrame(transfers_.queuedSpans(), transfers_.queuedPixels());
+    profiler_.report();
+}
+
+// The strips hold stale pixels outside what was drawn this pass, so a part
+// is widened to the whole pixel pairs diffSpans() compares
+static Rect bandPart(const Rect &changed, const Rect &band) {
+    Rect part = intersectRect(changed, band);
+    if (part.isEmpty()) return part;
+    part.left &= ~1;
+    part.right = (part.right + 1) & ~1;
+    if (part.right > band.right) part.right = band.right;
+    return part;
+}
+
+void Controller::renderBands(Scene &scene) {
+    int w = lcd_.width();
+    int h = lcd_.height();
+
+    // Only this frame's changes can differ from the panel. Each changed part
+    // of a band is drawn twice, as shownScene_ left it and as it is now, and
+    // exactly the pixels that differ are sent.
+    Rect hud = profiler_.hudRect();
+    for (int y0 = 0; y0 < h; y0 += BAND_HEIGHT) {
+        Rect band = {0, y0, w, y0 + BAND_HEIGHT < h ? y0 + BAND_HEIGHT : h};
+        Rect hudPart = intersectRect(hud, band);
+        if (hudPart.isEmpty() && !scene.changed.intersects(band)) continue;
+
+        // The new band goes to one strip and the shown one to the other, so
+        // strips take turns; DMA streams a band while the next is drawn
+        uint8_t source = bandFlip_;
+        uint8_t shown = source ^ 1;
+        bandFlip_ = shown;
+        uint16_t* pixels = (uint16_t*)sprites_[source]->getBuffer();
+        uint16_t* before = (uint16_t*)sprites_[shown]->getBuffer();
+
+        // View the strips as full-height canvases so entities keep drawing in
+        // screen coordinates; clips keep every write inside the strip.
+        ProfileLap lap(profiler_);
+        transfers_.fence(source);
+        lap.mark(PROFILE_FENCE);
+        bandView_.setBuffer(pixels - y0 * w, w, h);
+        for (int i = 0; i < scene.changed.size(); i++) {
+            Rect part = bandPart(scene.changed[i], band);
+            if (!part.isEmpty()) drawBandPart(scene, &bandView_, part);
+        }
+        // The HUD last shown can't be redrawn, so its rows are always resent
+        if (!hudPart.isEmpty()) {
+            drawBandPart(scene, &bandView_, hudPart);
+            profiler_.drawHud(&bandView_);
+        }
+        lap.mark(PROFILE_DRAW);
+        transfers_.fence(shown);
+        lap.mark(PROFILE_FENCE);
+        bandView_.setBuffer(before - y0 * w, w, h);
+        for (int i = 0; i < scene.changed.size(); i++) {
+            Rect part = bandPart(scene.changed[i], band);
+            if (!part.isEmpty()) drawBandPart(shownScene_, &bandView_, part);
+        }
+        lap.mark(PROFILE_DRAW);
+
+        for (int i = 0; i < scene.changed.size(); i++) {
+            Rect part = bandPart(scene.changed[i], band);
+            if (part.isEmpty()) continue;
+            diffSpans(pixels - y0 * w, before - y0 * w, w, part,
+                [&](int x, int y, int len, const uint16_t *span) { transfers_.enqueue(source, x, y, len, span); });
+        }
+        for (int y = hudPart.top; y < hudPart.bottom; y++) {
+            transfers_.enqueue(source, hudPart.left, y, hudPart.right - hudPart.left,
+                               pixels + (y - y0) * w + hudPart.left);
+        }
+        lap.mark(PROFILE_DIFF);
+    }
+    shownScene_ = scene;
+}
+
+void Controller::drawBandPart(Scene &scene, LGFX_Sprite* view, const Rect &part) {
+    view->setClipRect(part.left, part.top, part.right - part.left, part.bottom - part.top);
+    view->fillRect(part.left, part.top, part.right - part.left, part.bottom - part.top, 0);
+    drawEntities(scene, view, &part);
 }
 
 void Controller::service() {
@@ -359,5 +764,91 @@ void Controller::service() {
     if (buttons_.poll(rep)) {
         handleReport(rep);
     }
-    drawfunc();
-}
\ No newline at end of file
+
+    int ticks = simClock_.ticksDue();
+    if (ticks == 0) {
+        pumpTransfers();
+        leds_.pump();
+        return;
+    }
+    uint32_t start = micros();
+    // Every tick's changes must reach the screen, not just the last one's
+    ticksChanged_.clear();
+    for (int i = 0; i < ticks; i++) {
+        simulate();
+        ticksChanged_.add(scene_.changed);
+    }
+    scene_.changed = ticksChanged_;
+    uint32_t renderStart = micros();
+    render(scene_);
+    uint32_t end = micros();
+    recordRender(end - renderStart);
+    governor_.addFrame(end - start);
+}
+
+void Controller::publishScene() {
+    Scene& out = handoff_.back();
+    out = scene_;
+    out.changed.add(skippedChanged_);
+    skippedChanged_.clear();
+    // A frame the renderer never saw still changed the screen; carry it over
+    if (handoff_.publish()) skippedChanged_ = handoff_.back().changed;
+}
+
+bool Controller::startPipeline() {
+    if (pipelined_) return true;
+    pipelined_ = true;
+    simClock_.start();
+    // Size every snapshot up front so publishing never allocates
+    handoff_.forEachBuffer([&](Scene &buffer) {
+        buffer = scene_;
+        reserveScene(buffer);
+    });
+    if (!startPinnedTask("pond-render", RENDER_CORE, renderTask, this)) {
+        pipelined_ = false;
+        return false;
+    }
+    return startPinnedTask("pond-sim", SIM_CORE, simTask, this);
+}
+
+void Controller::simTask(void *arg) {
+    Controller* self = static_cast<Controller*>(arg);
+    for (;;) {
+        self->buttons_.service();
+        ButtonGroup::Report rep;
+        if (self->buttons_.poll(rep)) {
+            self->handleReport(rep);
+        }
+        // The clock sets the pace; a slow renderer just sees fewer of the
+        // published ticks, their changes carried over by publishScene().
+        int ticks = self->simClock_.ticksDue();
+        if (ticks == 0) {
+            self->leds_.pump();
+            yieldTask();
+            continue;
+        }
+        for (int i = 0; i < ticks; i++) {
+            // The slower of the two cores sets the frame rate
+            uint32_t start = micros();
+            self->simulate();
+            self->publishScene();
+            uint32_t cost = micros() - start;
+            uint32_t renderCost = self->renderMicros_.load(std::memory_order_relaxed);
+            self->governor_.addFrame(cost > renderCost ? cost : renderCost);
+        }
+    }
+}
+
+void Controller::renderTask(void *arg) {
+    Controller* self = static_cast<Controller*>(arg);
+    for (;;) {
+        if (self->handoff_.acquire()) {
+            uint32_t start = micros();
+            self->render(self->handoff_.front());
+            self->recordRender(micros() - start);
+        } else {
+            self->transfers_.pump();
+            yieldTask();
+        }
+    }
+}
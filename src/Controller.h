@@ -5,12 +5,44 @@
 #include <Adafruit_NeoPixel.h>
 #include <LovyanGFX.hpp>
 #include <config.hpp>
+#include <atomic>
 #include <vector>
 
-#include "animation/fish/Fish.h"
-#include "animation/leaf/Leaf.h"
-#include "animation/leaf/DuckWeed.h"
-#include "animation/ripple/Ripple.h"
+#include "DensityGovernor.h"
+#include "DirtyRegion.h"
+#include "FishDetailBudget.h"
+#include "FrameHandoff.h"
+#include "LedEngine.h"
+#include "Profiler.h"
+#include "Scene.h"
+#include "SimClock.h"
+#include "animation/Palette.h"
+#include "SpatialGrid.h"
+#include "TransferQueue.h"
+
+#define SIM_CORE 0
+#define RENDER_CORE 1
+// Sequential mode runs on RENDER_CORE, so the push task takes the other one
+#define PUSH_CORE 0
+
+// Band mode: rows rasterized per pass
+#define BAND_HEIGHT 12
+
+// At the sparsest density random ripples come this many times less often,
+// and start at this fraction of their intensity: dimmer, smaller rings
+#define SPARSE_RIPPLE_STRETCH 3.0f
+#define SPARSE_RIPPLE_INTENSITY 0.4f
+// Duckweed started fading in per tick while the density grows
+#define DENSITY_SPAWNS_PER_TICK 2
+
+// Strip colours: held swim buttons light their LED, dashes flash the whole
+// strip and each random ripple pulses the LED nearest to it
+#define LED_BRIGHTNESS 60
+#define LED_SWIM_COLOR 0x3E913C
+#define LED_DASH_COLOR 0x80B0FF
+#define LED_DASH_PULSE_MS 400
+#define LED_RIPPLE_COLOR 0x2040A0
+#define LED_RIPPLE_PULSE_MS 300
 
 class Controller{
     public:
@@ -21,39 +53,215 @@ class Controller{
                    Adafruit_NeoPixel &pixels
                 );
 
+        // Full-frame mode clears, redraws and diffs only the rects that
+        // changed; false always takes the whole-frame path, the reference
+        // the dirty rects must match. Call before begin().
+        void setDirtyRects(bool enabled) { dirtyRects_ = enabled; }
+        // Renders the screen in BAND_HEIGHT strips instead of two full-screen
+        // sprites; sp0/sp1 then only hold one strip each. Every changed part
+        // is drawn twice, as shownScene_ left it and as it is now, so only
+        // changed pixels are sent: on the host that doubles the band draw
+        // phase and costs about 35% more than resending hashed chunks did.
+        // Call before begin().
+        void setBandRendering(bool enabled) { bandRendering_ = enabled; }
+        // Draws into 8-bit palette sprites, half the RAM of RGB565 ones, and
+        // expands only the spans sent to the panel. Full-frame mode only;
+        // band strips stay RGB565. Call before begin().
+        void setIndexedColor(bool enabled) { indexedColor_ = enabled; }
+        // Sequential mode: a task on PUSH_CORE starts each changed span as
+        // the previous one leaves the bus, so a frame streams out while the
+        // next ticks simulate instead of only when service() pumps the
+        // queue. Not with startPipeline(). Call before begin().
+        void setPushTask(bool enabled) { pushTask_ = enabled; }
+        const Palette &palette() const { return palette_; }
+        // Corner overlay with the per-phase timings; needs -DPOND_PROFILE
+        void setProfileHud(bool enabled) { profiler_.setHud(enabled); }
+        const Profiler &profiler() const { return profiler_; }
+        // Fixes the scene seed so a run can be replayed exactly; otherwise
+        // begin() takes one from the hardware RNG. Call before begin().
+        void setSeed(uint32_t seed) { seed_ = seed; hasSeed_ = true; }
+        uint32_t seed() const { return seed_; }
+        // How many of each entity begin() creates. Call before begin().
+        void setPopulation(int fishes, int leaves, int duckWeeds) {
+            numFishes_ = fishes;
+            numLeaves_ = leaves;
+            minDuckWeeds_ = maxDuckWeeds_ = duckWeeds;
+        }
+        // Species begin() picks from, fish i taking species[i % count]. The
+        // array must outlive the controller; the default is koi only.
+        void setSpecies(const FishSpecies *const *species, int count) {
+            species_ = species;
+            speciesCount_ = count;
+        }
+        // Random ripples arrive every minMs..maxMs at full density
+        void setRippleCadence(unsigned long minMs, unsigned long maxMs) {
+            rippleMinMs_ = minMs;
+            rippleMaxMs_ = maxMs;
+        }
+        // Holds fps by fading duckweed in and out between the two counts and
+        // by spacing out and dimming random ripples; 0 fps freezes the
+        // current density.
+        // Safe to call at any time from the simulation side.
+        void setTargetFps(int fps, int minDuckWeeds, int maxDuckWeeds);
+
+        struct Density {
+            int level;          // 0..GOVERNOR_LEVELS
+            int duckWeeds;      // alive, including those fading in
+            int ripples;
+            float rippleStretch;
+            float rippleIntensity;  // of new random ripples
+            uint32_t frameMicros;
+        };
+        Density density() const;
+
+        // Lowers fish drawing detail while a frame's render takes longer than
+        // renderMicros; 0 (the default) always draws fish in full
+        void setFishDetailBudget(uint32_t renderMicros) { fishDetail_.setBudget(renderMicros); }
+        const FishDetailBudget &fishDetail() const { return fishDetail_; }
+
+        // Sends LED frames through bus instead of the NeoPixel library, e.g.
+        // an RmtLedBus; nullptr restores the library. Call before begin().
+        void setLedBus(LedBus *bus) { leds_.setBus(bus ? *bus : neoPixelBus_); }
+        const LedEngine &leds() const { return leds_; }
+
+        // Replaces the wall clock that paces simulation ticks, e.g. with a
+        // ManualClock for headless runs; nullptr restores millis().
+        void setClock(Clock *clock) { simClock_.setClock(clock); }
+
         void begin();
         void handleReport(const ButtonGroup::Report &rep);
+        // Sequential mode: runs the simulation ticks that are due, then draws
+        // one frame if any ran
         void service();
+        // Pipelined mode: simulation and rendering run as separate tasks on
+        // SIM_CORE and RENDER_CORE; service() must not be called afterwards.
+        bool startPipeline();
 
     private:
         LGFX &lcd_;
         LGFX_Sprite *sprites_[2];
         ButtonGroup &buttons_;
         Adafruit_NeoPixel &pixels_;
+        NeoPixelLedBus neoPixelBus_;
+        // Composed on the simulation side; only changed frames are sent
+        LedEngine leds_;
 
-        std::vector<Fish> fishes_;
-        std::vector<Leaf> leaves_;
-        std::vector<DuckWeed> duckWeeds_;
-        std::vector<Ripple> ripples_;
+        // Changed spans stream out over DMA while the next frame simulates
+        LgfxSpanBus bus_;
+        TransferQueue transfers_;
+        bool pushTask_ = false;
 
-        volatile std::uint32_t _draw_count = 0;
-        void diffDraw(LGFX_Sprite* sp0, LGFX_Sprite* sp1);
-        void drawfunc(void);
-        
-        // Collisions
+        uint32_t seed_ = 0;
+        bool hasSeed_ = false;
+        Random rippleRandom_;
+        int numFishes_ = 5;
+        const FishSpecies *const *species_ = FISH_SPECIES;
+        int speciesCount_ = 1;
+        int numLeaves_ = 15;
+
+        // Density: the governor's level picks the duckweed count within
+        // [minDuckWeeds_, maxDuckWeeds_], the ripple cadence stretch and the
+        // intensity new ripples start at
+        DensityGovernor governor_;
+        int minDuckWeeds_ = 50;
+        int maxDuckWeeds_ = 50;
+        unsigned long rippleMinMs_ = 2000;
+        unsigned long rippleMaxMs_ = 7000;
+        // Last frame's render cost, written by whichever side renders, then
+        // renderedFrames_ is bumped to publish it
+        std::atomic<uint32_t> renderMicros_{0};
+        std::atomic<uint32_t> renderedFrames_{0};
+        // The budget takes each rendered frame once, however many ticks ran
+        FishDetailBudget fishDetail_;
+        uint32_t budgetedFrames_ = 0;
+        void recordRender(uint32_t micros);
+        void updateFishDetail();
+        int targetDuckWeeds() const;
+        float rippleStretch() const;
+        float rippleIntensity() const;
+        unsigned long nextRippleCooldown();
+        void applyDensity();
+
+        // Simulation side. simulate() is one fixed SIM_TICK_MS step;
+        // simMillis_ is simulated time, independent of the frame rate.
+        SimClock simClock_;
+        unsigned long simMillis_ = 0;
+        Scene scene_;
+        DirtyRegion retiredRegion_;
+        DirtyRegion ticksChanged_;
+        RipplePool bouncedRipples_;
+        void simulate();
+        void trackScene();
+        void pumpTransfers();
+        // Sizes a copy of the live scene so assigning to it never allocates
+        void reserveScene(Scene &scene) const;
+
+        // Collisions. Plant positions are bucketed once per step, after
+        // physics, so each query only visits nearby plants.
+        SpatialGrid leafGrid_;
+        SpatialGrid duckWeedGrid_;
+        void indexPlants();
         void detectFishLeafCollision();
         void detectFishDuckWeedCollision();
         void detectRippleLeafCollision();
         void detectRippleDuckWeedCollision();
         void detectFishFishCollision(); 
 
+        // Phase timings and push counts, compiled out without POND_PROFILE
+        Profiler profiler_;
+
+        // Render side. The sprite being drawn still holds the frame before
+        // last, so the previous frame's changes are redrawn as well.
+        volatile std::uint32_t _draw_count = 0;
+        bool dirtyRects_ = true;
+        DirtyRegion lastChanged_;
+        DirtyRegion redrawRegion_;
+        void render(Scene &scene);
+        void finishFrame();
+        void drawEntities(Scene &scene, LGFX_Sprite* sprite, const Rect *clip);
+        void diffDraw(uint8_t source, LGFX_Sprite* sp0, LGFX_Sprite* sp1, const Rect &area);
+
+        // Indexed colour: every colour drawn goes through palette_ at
+        // begin(); rippleInk_ holds the ripples' grey ramp. Halves the two
+        // 240x320 sprites (307,200 B to 153,600 B), but word-wide diffs
+        // push about 23% more pixels than RGB565.
+        bool indexedColor_ = false;
+        Palette palette_;
+        uint16_t rippleInk_[256];
+
+        // Band mode. There is no previous frame to diff against, so the
+        // scene the panel shows is kept instead and redrawn wherever the new
+        // one changed.
+        bool bandRendering_ = false;
+        LGFX_Sprite bandView_;
+        Scene shownScene_;
+        uint8_t bandFlip_ = 0;
+        void renderBands(Scene &scene);
+        void drawBandPart(Scene &scene, LGFX_Sprite* view, const Rect &part);
+
+        // Pipelined mode
+        bool pipelined_ = false;
+        FrameHandoff<Scene> handoff_;
+        DirtyRegion skippedChanged_;
+        void publishScene();
+        static void simTask(void *arg);
+        static void renderTask(void *arg);
+
         unsigned long lastRippleTime_ = 0;
         unsigned long rippleCooldown_ = 0;
         float rippleIntensity_ = 60.0f;
 
+        // Input dispatch: handlers indexed by report event and button role
+        typedef void (Controller::*InputHandler)(const ButtonGroup::Report &rep);
+        static const InputHandler INPUT_HANDLERS[BUTTON_EVENTS][BUTTON_ROLES];
+        void onLeftButton(const ButtonGroup::Report &rep);
+        void onRightButton(const ButtonGroup::Report &rep);
+        void onBottomButton(const ButtonGroup::Report &rep);
+        void onSpreadButton(const ButtonGroup::Report &rep);
+
         // Button Interaction Flags
         bool swimTopLeft_ = false;
         bool swimTopRight_ = false;
         bool swimBottomCenter_ = false;
         bool spreadHolding_ = false;
-};
\ No newline at end of file
+};
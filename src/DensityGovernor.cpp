@@ -0,0 +1,34 @@
+#include "DensityGovernor.h"
+
+void DensityGovernor::setTargetFps(int fps) {
+    targetFps_ = fps > 0 ? fps : 0;
+    windowSum_ = 0;
+    windowFrames_ = 0;
+}
+
+void DensityGovernor::setLevel(int level) {
+    if (level < 0) level = 0;
+    if (level > GOVERNOR_LEVELS) level = GOVERNOR_LEVELS;
+    level_ = level;
+}
+
+bool DensityGovernor::addFrame(uint32_t costMicros) {
+    windowSum_ += costMicros;
+    if (++windowFrames_ < GOVERNOR_WINDOW) return false;
+    frameMicros_ = windowSum_ / windowFrames_;
+    windowSum_ = 0;
+    windowFrames_ = 0;
+    if (!enabled()) return false;
+
+    // One step per window, so the effect of a change is measured before the next
+    uint32_t budget = 1000000 / targetFps_;
+    int level = level_;
+    if (frameMicros_ > budget && level > 0) {
+        level--;
+    } else if (frameMicros_ < budget * GOVERNOR_HEADROOM && level < GOVERNOR_LEVELS) {
+        level++;
+    }
+    if (level == level_) return false;
+    level_ = level;
+    return true;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+
+// Density levels run from 0 (sparsest) to GOVERNOR_LEVELS (richest). A
+// decision is made every GOVERNOR_WINDOW frames from their mean cost; the
+// scene only grows while that stays under GOVERNOR_HEADROOM of the budget.
+#define GOVERNOR_LEVELS 10
+#define GOVERNOR_WINDOW 30
+#define GOVERNOR_HEADROOM 0.8f
+
+// Steps the scene density up or down to hold a target frame rate. It only
+// picks a level; the Controller maps that onto duckweed and ripple cadence.
+class DensityGovernor {
+    public:
+        // 0 turns the governor off and leaves the level where it is
+        void setTargetFps(int fps);
+        int targetFps() const { return targetFps_; }
+        bool enabled() const { return targetFps_ > 0; }
+
+        void setLevel(int level);
+        int level() const { return level_; }
+
+        // Adds one frame's cost; returns true when the level changed
+        bool addFrame(uint32_t costMicros);
+        // Mean cost over the last full window
+        uint32_t frameMicros() const { return frameMicros_; }
+
+    private:
+        int targetFps_ = 0;
+        int level_ = GOVERNOR_LEVELS;
+        uint32_t windowSum_ = 0;
+        int windowFrames_ = 0;
+        uint32_t frameMicros_ = 0;
+};
@@ -0,0 +1,67 @@
+#include "DirtyRegion.h"
+
+// Merging costs a little overdraw but saves a pass over the entity list,
+// so neighbours are joined when the union wastes fewer pixels than this.
+#define MERGE_SLACK_PIXELS 256
+
+void DirtyRegion::setBounds(int width, int height) {
+    bounds_ = {0, 0, width, height};
+    count_ = 0;
+}
+
+void DirtyRegion::add(const Rect &rect) {
+    Rect r = intersectRect(rect, bounds_);
+    if (r.isEmpty()) return;
+
+    for (int i = 0; i < count_; ) {
+        Rect merged = unionRect(r, rects_[i]);
+        bool overlap = ::intersects(r, rects_[i]);
+        if (overlap || merged.area() <= r.area() + rects_[i].area() + MERGE_SLACK_PIXELS) {
+            r = merged;
+            removeAt(i);
+            i = 0; // The grown rect may now reach earlier entries
+            continue;
+        }
+        i++;
+    }
+
+    if (count_ == MAX_DIRTY_RECTS) {
+        // Full: fold the new rect into whichever entry grows the least
+        int best = 0;
+        int bestGrowth = -1;
+        for (int i = 0; i < count_; i++) {
+            int growth = unionRect(r, rects_[i]).area() - rects_[i].area();
+            if (bestGrowth < 0 || growth < bestGrowth) {
+                bestGrowth = growth;
+                best = i;
+            }
+        }
+        r = unionRect(r, rects_[best]);
+        removeAt(best);
+        add(r);
+        return;
+    }
+
+    rects_[count_++] = r;
+}
+
+void DirtyRegion::add(const DirtyRegion &other) {
+    for (int i = 0; i < other.count_; i++) add(other.rects_[i]);
+}
+
+int DirtyRegion::area() const {
+    int sum = 0;
+    for (int i = 0; i < count_; i++) sum += rects_[i].area();
+    return sum;
+}
+
+bool DirtyRegion::intersects(const Rect &rect) const {
+    for (int i = 0; i < count_; i++) {
+        if (::intersects(rects_[i], rect)) return true;
+    }
+    return false;
+}
+
+void DirtyRegion::removeAt(int index) {
+    rects_[index] = rects_[--count_];
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "animation/helper.h"
+
+#define MAX_DIRTY_RECTS 32
+
+// A small set of non-overlapping screen rectangles that need redrawing.
+// Rects that touch or sit close together are merged, and once the set is
+// full the cheapest pair is merged, so coverage is always conservative.
+class DirtyRegion {
+    public:
+        void setBounds(int width, int height);
+        void clear() { count_ = 0; }
+
+        void add(const Rect &rect);
+        void add(const DirtyRegion &other);
+
+        int size() const { return count_; }
+        const Rect& operator[](int index) const { return rects_[index]; }
+        int area() const;
+        bool intersects(const Rect &rect) const;
+
+    private:
+        Rect rects_[MAX_DIRTY_RECTS];
+        int count_ = 0;
+        Rect bounds_ = {0, 0, 0, 0};
+
+        void removeAt(int index);
+};
@@ -0,0 +1,36 @@
+#include "FishDetailBudget.h"
+
+void FishDetailBudget::setBudget(uint32_t renderMicros) {
+    budgetMicros_ = renderMicros;
+    pressure_ = 0.0f;
+}
+
+void FishDetailBudget::update(uint32_t renderMicros, FishSchool &fishes) {
+    if (budgetMicros_ == 0) {
+        pressure_ = 0.0f;
+    } else if (renderMicros > budgetMicros_) {
+        pressure_ += FISH_DETAIL_RISE;
+    } else if (renderMicros < budgetMicros_ * FISH_DETAIL_HEADROOM) {
+        pressure_ -= FISH_DETAIL_FALL;
+    }
+    if (pressure_ < 0.0f) pressure_ = 0.0f;
+    if (pressure_ > FISH_DETAIL_TIERS - 1) pressure_ = FISH_DETAIL_TIERS - 1;
+
+    for (auto& fish : fishes) fish.setDetail(tierFor(fish));
+}
+
+FishDetail FishDetailBudget::tierFor(const Fish &fish) const {
+    int tier = fish.getDetail();
+    if (pressure_ == 0.0f) return FISH_DETAIL_FULL;
+
+    FishBounds b = fish.getBounds();
+    float area = (b.right - b.left) * (b.bottom - b.top);
+    float smallness = 1.0f - area / FISH_DETAIL_FULL_AREA;
+    if (smallness < 0.0f) smallness = 0.0f;
+    float score = pressure_ * (1.0f + smallness);
+
+    // Tier t owns scores within half a step of it; leaving takes the margin too
+    if (score > tier + 0.5f + FISH_DETAIL_HYSTERESIS && tier < FISH_DETAIL_TIERS - 1) tier++;
+    else if (score < tier - 0.5f - FISH_DETAIL_HYSTERESIS && tier > 0) tier--;
+    return (FishDetail)tier;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <stdint.h>
+
+#include "animation/fish/FishSchool.h"
+
+// Pressure rises quickly while the last frame's render ran over budget and
+// drains slowly once it is back under FISH_DETAIL_HEADROOM of it.
+#define FISH_DETAIL_RISE 0.25f
+#define FISH_DETAIL_FALL 0.05f
+#define FISH_DETAIL_HEADROOM 0.7f
+// Fish whose bounds cover less than this many pixels feel up to twice the
+// pressure, so small ones lose detail first
+#define FISH_DETAIL_FULL_AREA 2500.0f
+// A fish only changes tier once its score is this far past the boundary
+#define FISH_DETAIL_HYSTERESIS 0.25f
+
+// Picks a FishDetail tier per fish each frame from the previous frame's
+// render cost and each fish's on-screen size. One tier step per fish per
+// frame at most, so detail never flickers between neighbouring frames.
+class FishDetailBudget {
+    public:
+        // Render time per frame to stay under; 0 draws every fish in full
+        void setBudget(uint32_t renderMicros);
+        uint32_t budget() const { return budgetMicros_; }
+
+        // Feeds the last frame's render cost and retiers the fishes; call
+        // once per rendered frame
+        void update(uint32_t renderMicros, FishSchool &fishes);
+        // 0 (no pressure) .. FISH_DETAIL_TIERS - 1
+        float pressure() const { return pressure_; }
+
+    private:
+        uint32_t budgetMicros_ = 0;
+        float pressure_ = 0.0f;
+        FishDetail tierFor(const Fish &fish) const;
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Lock-free triple buffer between one producer and one consumer. The
+// producer fills back() and publishes it; the consumer picks up the most
+// recent published frame. Neither side ever waits on the other.
+template <typename T>
+class FrameHandoff {
+    public:
+        // Producer side
+        T& back() { return buffers_[back_]; }
+        // Returns true when the frame it replaces was never acquired; that
+        // frame is now back() again.
+        bool publish() {
+            uint8_t prev = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel);
+            back_ = prev & INDEX;
+            return (prev & FRESH) != 0;
+        }
+        // True while the last published frame is still waiting to be acquired
+        bool pending() const { return (middle_.load(std::memory_order_acquire) & FRESH) != 0; }
+
+        // Consumer side
+        bool acquire() {
+            if (!pending()) return false;
+            uint8_t prev = middle_.exchange(front_, std::memory_order_acq_rel);
+            front_ = prev & INDEX;
+            return true;
+        }
+        T& front() { return buffers_[front_]; }
+
+        // Setup only, before either side runs: calls fn on every buffer
+        template <typename Fn>
+        void forEachBuffer(Fn fn) {
+            for (auto& buffer : buffers_) fn(buffer);
+        }
+
+    private:
+        static constexpr uint8_t INDEX = 0x03;
+        static constexpr uint8_t FRESH = 0x04;
+
+        T buffers_[3];
+        uint8_t back_ = 0;
+        std::atomic<uint8_t> middle_{1};
+        uint8_t front_ = 2;
+};
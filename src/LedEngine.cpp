@@ -0,0 +1,173 @@
+#include "LedEngine.h"
+
+// Channel-wise mix of two 0xRRGGBB colours, t in [0, 256]
+static uint32_t mixColor(uint32_t a, uint32_t b, uint32_t t) {
+    uint32_t out = 0;
+    for (int shift = 0; shift <= 16; shift += 8) {
+        int ca = (a >> shift) & 0xFF;
+        int cb = (b >> shift) & 0xFF;
+        out |= (uint32_t)(ca + ((cb - ca) * (int)t >> 8)) << shift;
+    }
+    return out;
+}
+
+static uint32_t addColor(uint32_t a, uint32_t b) {
+    uint32_t out = 0;
+    for (int shift = 0; shift <= 16; shift += 8) {
+        uint32_t c = ((a >> shift) & 0xFF) + ((b >> shift) & 0xFF);
+        out |= (c > 0xFF ? 0xFF : c) << shift;
+    }
+    return out;
+}
+
+void NeoPixelLedBus::begin(int count) {
+    (void)count;
+    pixels_.begin();
+}
+
+void NeoPixelLedBus::write(const uint32_t *colors, int count) {
+    for (int i = 0; i < count; i++) pixels_.setPixelColor(i, colors[i]);
+    pixels_.show();
+}
+
+#ifdef ARDUINO_ARCH_ESP32
+// 100 ns ticks: a 0 bit is 0.4 us high, 0.8 us low; a 1 bit the reverse
+#define RMT_TICK_HZ 10000000
+#define WS2812_T0H 4
+#define WS2812_T0L 8
+#define WS2812_T1H 8
+#define WS2812_T1L 4
+
+void RmtLedBus::begin(int count) {
+    (void)count;
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+    ready_ = rmtInit(pin_, RMT_TX_MODE, RMT_MEM_NUM_BLOCKS_1, RMT_TICK_HZ);
+#else
+    rmt_ = rmtInit(pin_, RMT_TX_MODE, RMT_MEM_64);
+    if (rmt_) rmtSetTick(rmt_, 1000000000 / RMT_TICK_HZ);
+    ready_ = rmt_ != nullptr;
+#endif
+}
+
+void RmtLedBus::write(const uint32_t *colors, int count) {
+    if (!ready_) return;
+    if (count > LED_MAX_PIXELS) count = LED_MAX_PIXELS;
+
+    // Encode into the buffer not on the wire; the one still sending is left
+    // alone until its frame is out
+    rmt_data_t *symbols = symbols_[nextSymbols_];
+    nextSymbols_ ^= 1;
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        uint32_t c = colors[i];
+        uint32_t grb = ((c >> 8) & 0xFF) << 16 | ((c >> 16) & 0xFF) << 8 | (c & 0xFF);
+        for (int bit = 23; bit >= 0; bit--) {
+            bool one = (grb >> bit) & 1;
+            symbols[n].level0 = 1;
+            symbols[n].duration0 = one ? WS2812_T1H : WS2812_T0H;
+            symbols[n].level1 = 0;
+            symbols[n].duration1 = one ? WS2812_T1L : WS2812_T0L;
+            n++;
+        }
+    }
+    // Neither call copies the symbols: they are fed to the peripheral as it
+    // sends. Core 3.x returns at once; pump() waits for busy() to clear
+    // before the next write, so one spare buffer is enough. Core 2.x blocks
+    // here until the previous frame is out, then returns while this one
+    // still sends.
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+    rmtWriteAsync(pin_, symbols, n);
+#else
+    rmtWrite(rmt_, symbols, n);
+#endif
+}
+
+bool RmtLedBus::busy() {
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+    return ready_ && !rmtTransmitCompleted(pin_);
+#else
+    // Core 2.x has no completion query; rmtWrite() itself waits out a
+    // frame still in flight, which at LED_MAX_PIXELS is under 250 us
+    return false;
+#endif
+}
+#endif
+
+void LedEngine::begin(int count) {
+    count_ = count < LED_MAX_PIXELS ? count : LED_MAX_PIXELS;
+    for (int i = 0; i < count_; i++) {
+        from_[i] = target_[i] = 0;
+        fadeStart_[i] = 0;
+        frame_[i] = shown_[i] = 0;
+    }
+    pulseCount_ = 0;
+    bus_->begin(count_);
+    // Start from a known dark strip
+    bus_->write(frame_, count_);
+    frames_ = 1;
+    dirty_ = false;
+}
+
+uint32_t LedEngine::baseColor(int index) const {
+    unsigned long elapsed = nowMs_ - fadeStart_[index];
+    if (elapsed >= LED_FADE_MS) return target_[index];
+    return mixColor(from_[index], target_[index], elapsed * 256 / LED_FADE_MS);
+}
+
+void LedEngine::setTarget(int index, uint32_t color) {
+    if (index < 0 || index >= count_ || target_[index] == color) return;
+    // Restart from wherever the current fade has got to
+    from_[index] = baseColor(index);
+    target_[index] = color;
+    fadeStart_[index] = nowMs_;
+}
+
+void LedEngine::pulse(uint8_t mask, uint32_t color, uint16_t durationMs) {
+    if (durationMs == 0) return;
+    // A full table gives up its oldest pulse
+    if (pulseCount_ == LED_MAX_PULSES) {
+        for (int i = 1; i < pulseCount_; i++) pulses_[i - 1] = pulses_[i];
+        pulseCount_--;
+    }
+    pulses_[pulseCount_++] = {color, nowMs_, durationMs, mask};
+}
+
+void LedEngine::update(unsigned long nowMs) {
+    nowMs_ = nowMs;
+
+    // Drop finished pulses, keeping the rest in order
+    int kept = 0;
+    for (int p = 0; p < pulseCount_; p++) {
+        if (nowMs_ - pulses_[p].startMs < pulses_[p].durationMs) pulses_[kept++] = pulses_[p];
+    }
+    pulseCount_ = kept;
+
+    for (int i = 0; i < count_; i++) {
+        uint32_t color = baseColor(i);
+        for (int p = 0; p < pulseCount_; p++) {
+            const Pulse &pulse = pulses_[p];
+            if (!(pulse.mask & (1 << i))) continue;
+            uint32_t left = pulse.durationMs - (nowMs_ - pulse.startMs);
+            color = addColor(color, mixColor(0, pulse.color, left * 256 / pulse.durationMs));
+        }
+        if (brightness_ != 255) color = mixColor(0, color, brightness_ + 1);
+        if (color != frame_[i]) {
+            frame_[i] = color;
+            dirty_ = true;
+        }
+    }
+}
+
+void LedEngine::pump() {
+    if (!dirty_ || bus_->busy()) return;
+    dirty_ = false;
+    // Fades can settle back on the colours already showing
+    bool same = true;
+    for (int i = 0; i < count_; i++) {
+        if (frame_[i] != shown_[i]) same = false;
+        shown_[i] = frame_[i];
+    }
+    if (same) return;
+    bus_->write(shown_, count_);
+    frames_++;
+}
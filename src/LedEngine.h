@@ -0,0 +1,115 @@
+#pragma once
+#include <Arduino.h>
+#include <Adafruit_NeoPixel.h>
+
+#define LED_MAX_PIXELS 8
+#define LED_MAX_PULSES 4
+// Base colours ease toward a new target over this long
+#define LED_FADE_MS 120
+
+// Something that can latch a frame of 0xRRGGBB colours onto the strip.
+// Kept abstract so the engine runs against the RMT peripheral, the NeoPixel
+// library or a recording stand-in.
+class LedBus {
+    public:
+        virtual ~LedBus() = default;
+        virtual void begin(int count) { (void)count; }
+        // Starts sending; `colors` may be reused as soon as this returns
+        virtual void write(const uint32_t *colors, int count) = 0;
+        // True while the previous frame is still going out
+        virtual bool busy() = 0;
+};
+
+// Sends through Adafruit_NeoPixel::show(), which holds the caller until the
+// last bit is out. The fallback when no RMT channel is set up.
+class NeoPixelLedBus : public LedBus {
+    public:
+        explicit NeoPixelLedBus(Adafruit_NeoPixel &pixels) : pixels_(pixels) {}
+
+        void begin(int count) override;
+        void write(const uint32_t *colors, int count) override;
+        bool busy() override { return false; }
+
+    private:
+        Adafruit_NeoPixel &pixels_;
+};
+
+#ifdef ARDUINO_ARCH_ESP32
+// Encodes a frame into RMT symbols and lets the peripheral clock them out
+// while the caller carries on. WS2812 timing, GRB order.
+class RmtLedBus : public LedBus {
+    public:
+        explicit RmtLedBus(int pin) : pin_(pin) {}
+
+        void begin(int count) override;
+        void write(const uint32_t *colors, int count) override;
+        bool busy() override;
+
+    private:
+        int pin_;
+        bool ready_ = false;
+        // The peripheral reads a frame's symbols while it sends them, so
+        // frames alternate between two buffers
+        rmt_data_t symbols_[2][LED_MAX_PIXELS * 24];
+        uint8_t nextSymbols_ = 0;
+#if ESP_ARDUINO_VERSION_MAJOR < 3
+        rmt_obj_t *rmt_ = nullptr;
+#endif
+};
+#endif
+
+// Composes the strip's colours from per-pixel base colours, which fade
+// toward their targets, and timed pulses layered on top. Runs on the
+// simulation side; the frame is only handed to the bus when it changed.
+class LedEngine {
+    public:
+        explicit LedEngine(LedBus &bus) : bus_(&bus) {}
+
+        // Call before begin()
+        void setBus(LedBus &bus) { bus_ = &bus; }
+        void setBrightness(uint8_t brightness) { brightness_ = brightness; }
+        void begin(int count);
+        int count() const { return count_; }
+
+        // Colour pixel `index` settles on, LED_FADE_MS after it changes
+        void setTarget(int index, uint32_t color);
+        // Adds `color` to every pixel in `mask`, fading out over durationMs
+        void pulse(uint8_t mask, uint32_t color, uint16_t durationMs);
+
+        // Moves fades and pulses on to nowMs and composes the frame
+        void update(unsigned long nowMs);
+        // Sends the composed frame if it differs from the strip and the bus
+        // is free; never waits
+        void pump();
+
+        // Frames handed to the bus since begin()
+        uint32_t frames() const { return frames_; }
+
+    private:
+        struct Pulse {
+            uint32_t color;
+            unsigned long startMs;
+            uint16_t durationMs;
+            uint8_t mask;
+        };
+
+        LedBus *bus_;
+        int count_ = 0;
+        uint8_t brightness_ = 255;
+        unsigned long nowMs_ = 0;
+
+        // Each base fade runs from `from` to `target`, starting at fadeStart
+        uint32_t from_[LED_MAX_PIXELS];
+        uint32_t target_[LED_MAX_PIXELS];
+        unsigned long fadeStart_[LED_MAX_PIXELS];
+
+        Pulse pulses_[LED_MAX_PULSES];
+        int pulseCount_ = 0;
+
+        uint32_t frame_[LED_MAX_PIXELS];
+        uint32_t shown_[LED_MAX_PIXELS];
+        bool dirty_ = false;
+        uint32_t frames_ = 0;
+
+        uint32_t baseColor(int index) const;
+};
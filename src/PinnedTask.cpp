@@ -0,0 +1,38 @@
+#include "PinnedTask.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+#define PINNED_TASK_STACK 8192
+#define PINNED_TASK_PRIORITY 1
+
+bool startPinnedTask(const char *name, int core, void (*fn)(void *), void *arg) {
+    return xTaskCreatePinnedToCore(fn, name, PINNED_TASK_STACK, arg, PINNED_TASK_PRIORITY, nullptr, core) == pdPASS;
+}
+
+void yieldTask() {
+    // vTaskDelay(0) would not let the idle task feed the watchdog
+    vTaskDelay(1);
+}
+
+void spinWait() {}
+
+#else
+#include <thread>
+
+bool startPinnedTask(const char *name, int core, void (*fn)(void *), void *arg) {
+    (void)name;
+    (void)core;
+    std::thread(fn, arg).detach();
+    return true;
+}
+
+void yieldTask() {
+    std::this_thread::yield();
+}
+
+void spinWait() {
+    std::this_thread::yield();
+}
+
+#endif
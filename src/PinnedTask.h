@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+
+// Runs `fn(arg)` on its own task pinned to `core`. FreeRTOS on the ESP32,
+// a detached std::thread elsewhere (core is ignored) so the pipeline can be
+// exercised on a host.
+bool startPinnedTask(const char *name, int core, void (*fn)(void *), void *arg);
+
+// Gives other tasks on this core a chance to run.
+void yieldTask();
+
+// Pause inside a busy-wait on another task. The host may run that task on
+// the same core, so it yields; on the ESP32 the other task has a core of
+// its own and the wait just spins.
+void spinWait();
@@ -0,0 +1,134 @@
+#include "Profiler.h"
+
+#ifdef POND_PROFILE
+#include <algorithm>
+
+#ifndef ARDUINO
+#include <chrono>
+#endif
+
+#define HUD_LINE_HEIGHT 8
+#define HUD_CHAR_WIDTH 6
+#define HUD_COLUMNS 20
+#define HUD_HEADER "       min  avg  p99"
+
+static const char *SERIES_NAMES[PROFILE_SERIES] = {
+    "leds", "rippl", "swim", "phys", "coll", "track",
+    "fence", "draw", "diff", "spans", "pix"
+};
+
+uint32_t Profiler::now() {
+#ifdef ARDUINO
+    return ESP.getCycleCount();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+uint32_t Profiler::toNanos(uint32_t ticks) {
+#ifdef ARDUINO
+    return (uint32_t)((uint64_t)ticks * 1000 / ESP.getCpuFreqMHz());
+#else
+    return ticks;
+#endif
+}
+
+void Profiler::commit(ProfileSeries series, uint32_t value) {
+    window_[series][next_[series]] = value;
+    next_[series] = (next_[series] + 1) % PROFILE_WINDOW;
+    if (count_[series] < PROFILE_WINDOW) count_[series]++;
+    total_[series] += value;
+    samples_[series]++;
+}
+
+void Profiler::commitTick() {
+    Tick tick;
+    for (int s = PROFILE_LEDS; s <= PROFILE_TRACK; s++) {
+        tick.phases[s] = toNanos(pending_[s]);
+        pending_[s] = 0;
+    }
+    ticks_.push(tick);
+}
+
+void Profiler::commitFrame(uint32_t spans, uint32_t pixels) {
+    Tick tick;
+    while (ticks_.pop(tick)) {
+        for (int s = PROFILE_LEDS; s <= PROFILE_TRACK; s++) commit((ProfileSeries)s, tick.phases[s]);
+    }
+    for (int s = PROFILE_FENCE; s <= PROFILE_DIFF; s++) {
+        commit((ProfileSeries)s, toNanos(pending_[s]));
+        pending_[s] = 0;
+    }
+    commit(PROFILE_SPANS, spans - lastSpans_);
+    commit(PROFILE_PIXELS, pixels - lastPixels_);
+    lastSpans_ = spans;
+    lastPixels_ = pixels;
+    hudAge_++;
+}
+
+ProfileStats Profiler::stats(ProfileSeries series) const {
+    int n = count_[series];
+    if (n == 0) return {0, 0, 0};
+
+    uint32_t sorted[PROFILE_WINDOW];
+    uint64_t sum = 0;
+    for (int i = 0; i < n; i++) {
+        sorted[i] = window_[series][i];
+        sum += sorted[i];
+    }
+    int rank = (n * 99 + 99) / 100 - 1;
+    std::nth_element(sorted, sorted + rank, sorted + n);
+    uint32_t p99 = sorted[rank];
+    uint32_t min = *std::min_element(sorted, sorted + n);
+    return {min, (uint32_t)(sum / n), p99};
+}
+
+void Profiler::formatLine(ProfileSeries series, char *out, size_t size) const {
+    ProfileStats s = stats(series);
+    // Phases are shown in microseconds
+    if (series < PROFILE_SPANS) {
+        s = {s.min / 1000, s.avg / 1000, s.p99 / 1000};
+    }
+    snprintf(out, size, "%-5s%5lu%5lu%5lu", SERIES_NAMES[series],
+             (unsigned long)s.min, (unsigned long)s.avg, (unsigned long)s.p99);
+}
+
+void Profiler::report() {
+    unsigned long t = millis();
+    if (t - lastReport_ < PROFILE_REPORT_MS) return;
+    lastReport_ = t;
+
+    char line[40];
+    Serial.printf("profile (us; spans and pixels per frame)\n  %s\n", HUD_HEADER);
+    for (int s = 0; s < PROFILE_SERIES; s++) {
+        formatLine((ProfileSeries)s, line, sizeof(line));
+        Serial.printf("  %s\n", line);
+    }
+}
+
+Rect Profiler::hudRect() const {
+    if (!hud_) return emptyRect();
+    return {0, 0, HUD_COLUMNS * HUD_CHAR_WIDTH + 2, (PROFILE_SERIES + 1) * HUD_LINE_HEIGHT + 2};
+}
+
+void Profiler::drawHud(LGFX_Sprite *sprite) {
+    if (!hud_) return;
+    if (hudAge_ >= PROFILE_HUD_FRAMES) {
+        for (int s = 0; s < PROFILE_SERIES; s++) {
+            formatLine((ProfileSeries)s, hudLines_[s], sizeof(hudLines_[s]));
+        }
+        hudAge_ = 0;
+    }
+
+    Rect r = hudRect();
+    sprite->fillRect(r.left, r.top, r.right - r.left, r.bottom - r.top, 0);
+    sprite->setTextSize(1);
+    sprite->setTextColor(hudInk_, 0);
+    sprite->drawString(HUD_HEADER, 1, 1);
+    for (int s = 0; s < PROFILE_SERIES; s++) {
+        sprite->drawString(hudLines_[s], 1, 1 + (s + 1) * HUD_LINE_HEIGHT);
+    }
+}
+
+#endif
@@ -0,0 +1,157 @@
+#pragma once
+#include <Arduino.h>
+#include <LovyanGFX.hpp>
+
+#include "SpscRing.h"
+#include "animation/helper.h"
+
+// Samples kept per series; min/avg/p99 are taken over this window
+#define PROFILE_WINDOW 128
+// Serial report period, in wall-clock ms
+#define PROFILE_REPORT_MS 5000
+// Frames between HUD text refreshes, so the numbers stay readable
+#define PROFILE_HUD_FRAMES 15
+// Closed ticks waiting for the next frame; holds SIM_MAX_CATCHUP_TICKS
+// with room to spare, a slower renderer drops the excess
+#define PROFILE_TICK_QUEUE 8
+
+// Simulation phases get one sample per tick, render phases and the push
+// counters one per frame. Phases are sampled in nanoseconds.
+enum ProfileSeries : uint8_t {
+    PROFILE_LEDS,
+    PROFILE_RIPPLES,
+    PROFILE_SWIM,
+    PROFILE_PHYSICS,
+    PROFILE_COLLISIONS,
+    PROFILE_TRACK,
+    PROFILE_FENCE,
+    PROFILE_DRAW,
+    PROFILE_DIFF,
+    PROFILE_SPANS,
+    PROFILE_PIXELS,
+    PROFILE_SERIES
+};
+
+struct ProfileStats {
+    uint32_t min;
+    uint32_t avg;
+    uint32_t p99;
+};
+
+#ifdef POND_PROFILE
+
+// Per-phase frame timing, built with -DPOND_PROFILE. Timestamps come from
+// the CPU cycle counter on device and std::chrono on the host. The windows
+// belong to the render side: commitTick() only queues the tick's phases,
+// and commitFrame() folds them in, so in pipelined mode the sim task never
+// touches what stats(), drawHud() and report() read.
+class Profiler {
+    public:
+        static uint32_t now();
+        static uint32_t toNanos(uint32_t ticks);
+
+        void add(ProfileSeries series, uint32_t ticks) { pending_[series] += ticks; }
+        // Sim side: closes the current sample of every simulation phase
+        void commitTick();
+        // Render side: takes in the queued ticks and closes the render
+        // phases; spans and pixels are running totals
+        void commitFrame(uint32_t spans, uint32_t pixels);
+
+        // Over the last PROFILE_WINDOW samples
+        ProfileStats stats(ProfileSeries series) const;
+        // Over every sample since start-up
+        uint64_t total(ProfileSeries series) const { return total_[series]; }
+        uint32_t samples(ProfileSeries series) const { return samples_[series]; }
+        // Prints one line per series every PROFILE_REPORT_MS
+        void report();
+
+        void setHud(bool enabled) { hud_ = enabled; }
+        bool hud() const { return hud_; }
+        Rect hudRect() const;
+        // Text colour, as a sprite colour; yellow by default
+        void setHudInk(uint16_t ink) { hudInk_ = ink; }
+        // Draws the overlay in the top-left corner; honours the sprite's clip
+        void drawHud(LGFX_Sprite *sprite);
+
+    private:
+        struct Tick {
+            uint32_t phases[PROFILE_TRACK + 1];
+        };
+
+        // Each series' pending time is added to by one task only
+        uint32_t pending_[PROFILE_SERIES] = {};
+        SpscRing<Tick, PROFILE_TICK_QUEUE> ticks_;
+        uint32_t window_[PROFILE_SERIES][PROFILE_WINDOW] = {};
+        uint16_t count_[PROFILE_SERIES] = {};
+        uint16_t next_[PROFILE_SERIES] = {};
+        uint64_t total_[PROFILE_SERIES] = {};
+        uint32_t samples_[PROFILE_SERIES] = {};
+
+        uint32_t lastSpans_ = 0;
+        uint32_t lastPixels_ = 0;
+        unsigned long lastReport_ = 0;
+
+        bool hud_ = false;
+        uint16_t hudInk_ = TFT_YELLOW;
+        int hudAge_ = PROFILE_HUD_FRAMES;
+        char hudLines_[PROFILE_SERIES][40] = {};
+
+        void commit(ProfileSeries series, uint32_t value);
+        void formatLine(ProfileSeries series, char *out, size_t size) const;
+};
+
+#else
+
+// Compiled out: every call is an empty inline
+class Profiler {
+    public:
+        static uint32_t now() { return 0; }
+        static uint32_t toNanos(uint32_t) { return 0; }
+
+        void add(ProfileSeries, uint32_t) {}
+        void commitTick() {}
+        void commitFrame(uint32_t, uint32_t) {}
+
+        ProfileStats stats(ProfileSeries) const { return {0, 0, 0}; }
+        uint64_t total(ProfileSeries) const { return 0; }
+        uint32_t samples(ProfileSeries) const { return 0; }
+        void report() {}
+
+        void setHud(bool) {}
+        bool hud() const { return false; }
+        Rect hudRect() const { return emptyRect(); }
+        void setHudInk(uint16_t) {}
+        void drawHud(LGFX_Sprite *) {}
+};
+
+#endif
+
+// Adds the time until the end of the enclosing block to one series
+class ProfileScope {
+    public:
+        ProfileScope(Profiler &profiler, ProfileSeries series)
+            : profiler_(profiler), series_(series), start_(Profiler::now()) {}
+        ~ProfileScope() { profiler_.add(series_, Profiler::now() - start_); }
+
+    private:
+        Profiler &profiler_;
+        ProfileSeries series_;
+        uint32_t start_;
+};
+
+// Splits a straight run of code into phases: each mark() charges the time
+// since the previous mark to one series
+class ProfileLap {
+    public:
+        explicit ProfileLap(Profiler &profiler)
+            : profiler_(profiler), start_(Profiler::now()) {}
+        void mark(ProfileSeries series) {
+            uint32_t t = Profiler::now();
+            profiler_.add(series, t - start_);
+            start_ = t;
+        }
+
+    private:
+        Profiler &profiler_;
+        uint32_t start_;
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include <vector>
+
+#include "DirtyRegion.h"
+#include "animation/fish/FishSchool.h"
+#include "animation/leaf/Leaf.h"
+#include "animation/leaf/DuckWeedField.h"
+#include "animation/ripple/Ripple.h"
+
+// Everything the renderer needs for one frame. The simulation owns the live
+// copy; in pipelined mode snapshots of it are handed to the render task.
+struct Scene {
+    FishSchool fishes;
+    std::vector<Leaf> leaves;
+    DuckWeedField duckWeeds;
+    RipplePool ripples;
+
+    // Filled after each simulation step, in draw order:
+    // fishes, duckWeeds, ripples, leaves.
+    std::vector<Rect> entityRects;
+    // Where this frame may differ from the previously rendered one
+    DirtyRegion changed;
+
+    // Upper bound on entityRects, so per-frame refills and snapshot copies
+    // never grow it
+    size_t entityCapacity() const {
+        return fishes.size() + duckWeeds.capacity() + MAX_RIPPLES + leaves.size();
+    }
+};
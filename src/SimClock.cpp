@@ -0,0 +1,20 @@
+#include "SimClock.h"
+
+void SimClock::start() {
+    last_ = clock_->now();
+    backlog_ = 0;
+}
+
+int SimClock::ticksDue() {
+    unsigned long now = clock_->now();
+    backlog_ += now - last_;
+    last_ = now;
+
+    unsigned long ticks = backlog_ / SIM_TICK_MS;
+    if (ticks > SIM_MAX_CATCHUP_TICKS) {
+        backlog_ = 0;
+        return SIM_MAX_CATCHUP_TICKS;
+    }
+    backlog_ -= ticks * SIM_TICK_MS;
+    return (int)ticks;
+}
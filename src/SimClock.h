@@ -0,0 +1,47 @@
+#pragma once
+#include <Arduino.h>
+
+// The simulation advances in fixed ticks no matter how fast frames render.
+// After a stall at most SIM_MAX_CATCHUP_TICKS run back to back; older
+// backlog is dropped so the pond slows down instead of spiralling.
+#define SIM_TICK_MS 33
+#define SIM_MAX_CATCHUP_TICKS 4
+
+// Wall-clock source for the simulation; inject a ManualClock for
+// reproducible headless runs.
+class Clock {
+    public:
+        virtual ~Clock() {}
+        virtual unsigned long now() = 0;
+};
+
+class ArduinoClock : public Clock {
+    public:
+        unsigned long now() override { return millis(); }
+};
+
+class ManualClock : public Clock {
+    public:
+        unsigned long now() override { return now_; }
+        void advance(unsigned long ms) { now_ += ms; }
+
+    private:
+        unsigned long now_ = 0;
+};
+
+// Converts elapsed wall-clock time into whole simulation ticks
+class SimClock {
+    public:
+        // nullptr restores the Arduino clock
+        void setClock(Clock *clock) { clock_ = clock ? clock : &arduinoClock_; }
+        // Starts counting from the current time with no backlog
+        void start();
+        // Ticks to run now, capped at SIM_MAX_CATCHUP_TICKS
+        int ticksDue();
+
+    private:
+        ArduinoClock arduinoClock_;
+        Clock *clock_ = &arduinoClock_;
+        unsigned long last_ = 0;
+        unsigned long backlog_ = 0;
+};
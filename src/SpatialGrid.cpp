@@ -0,0 +1,52 @@
+#include "SpatialGrid.h"
+#include <math.h>
+
+void SpatialGrid::setBounds(int width, int height, int cellSize) {
+    cellSize_ = cellSize;
+    cols_ = (width + cellSize - 1) / cellSize;
+    rows_ = (height + cellSize - 1) / cellSize;
+    if (cols_ < 1) cols_ = 1;
+    if (rows_ < 1) rows_ = 1;
+    cellStart_.assign(cols_ * rows_ + 1, 0);
+}
+
+void SpatialGrid::build() {
+    // Counting sort: histogram, prefix sum, then scatter
+    int cells = cols_ * rows_;
+    for (int c = 0; c <= cells; c++) cellStart_[c] = 0;
+    for (uint16_t cell : itemCell_) cellStart_[cell + 1]++;
+    for (int c = 0; c < cells; c++) cellStart_[c + 1] += cellStart_[c];
+
+    items_.resize(itemCell_.size());
+    // Scatter in index order; cellStart_ is shifted by one cell while filling
+    for (size_t i = 0; i < itemCell_.size(); i++) {
+        items_[cellStart_[itemCell_[i]]++] = (uint32_t)i;
+    }
+    for (int c = cells; c > 0; c--) cellStart_[c] = cellStart_[c - 1];
+    cellStart_[0] = 0;
+}
+
+int SpatialGrid::clampCol(float x) const {
+    int col = (int)floorf(x / cellSize_);
+    if (col < 0) return 0;
+    return col >= cols_ ? cols_ - 1 : col;
+}
+
+int SpatialGrid::clampRow(float y) const {
+    int row = (int)floorf(y / cellSize_);
+    if (row < 0) return 0;
+    return row >= rows_ ? rows_ - 1 : row;
+}
+
+void SpatialGrid::spanDistance(float v, int index, int count, float &nearest, float &farthest) const {
+    float lo = (float)(index * cellSize_);
+    float hi = lo + cellSize_;
+    bool openLo = index == 0;
+    bool openHi = index == count - 1;
+
+    if (v < lo) nearest = openLo ? 0 : lo - v;
+    else if (v > hi) nearest = openHi ? 0 : v - hi;
+    else nearest = 0;
+
+    farthest = (openLo || openHi) ? INFINITY : fmaxf(v - lo, hi - v);
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#define GRID_CELL_SIZE 32
+
+// Uniform bucket grid over the canvas. Items are added by index each frame,
+// then build() sorts them into cells so a query only walks the cells that
+// overlap its search box. Positions off the canvas land in the edge cells.
+class SpatialGrid {
+    public:
+        void setBounds(int width, int height, int cellSize = GRID_CELL_SIZE);
+
+        // Items are numbered in the order they are added; radius only feeds
+        // maxRadius() so queries can pad for the largest item.
+        void clear() { itemCell_.clear(); maxRadius_ = 0; }
+        void add(float x, float y, float radius = 0) {
+            itemCell_.push_back(cellIndex(x, y));
+            if (radius > maxRadius_) maxRadius_ = radius;
+        }
+        void build();
+        float maxRadius() const { return maxRadius_; }
+
+        // Calls visit(index) for every item in a cell overlapping the box
+        // around (x, y); callers still test the exact distance.
+        template <typename Visit>
+        void query(float x, float y, float radius, Visit visit) const {
+            int col0 = clampCol(x - radius), col1 = clampCol(x + radius);
+            int row0 = clampRow(y - radius), row1 = clampRow(y + radius);
+            for (int row = row0; row <= row1; row++) {
+                int cell = row * cols_;
+                for (uint32_t i = cellStart_[cell + col0]; i < cellStart_[cell + col1 + 1]; i++) {
+                    visit(items_[i]);
+                }
+            }
+        }
+
+        // Calls visit(nearestSq, farthestSq, first, last) for every non-empty
+        // cell overlapping the box around (x, y), where the two bound the
+        // squared distance from (x, y) to anything in the cell and
+        // [first, last) are its item indices. Lets ring queries pick the
+        // rings that can reach a cell before touching its items.
+        template <typename Visit>
+        void queryCells(float x, float y, float radius, Visit visit) const {
+            int col0 = clampCol(x - radius), col1 = clampCol(x + radius);
+            int row0 = clampRow(y - radius), row1 = clampRow(y + radius);
+            for (int row = row0; row <= row1; row++) {
+                float dyNear, dyFar;
+                spanDistance(y, row, rows_, dyNear, dyFar);
+                for (int col = col0; col <= col1; col++) {
+                    int cell = row * cols_ + col;
+                    if (cellStart_[cell] == cellStart_[cell + 1]) continue;
+
+                    float dxNear, dxFar;
+                    spanDistance(x, col, cols_, dxNear, dxFar);
+                    float nearestSq = dxNear * dxNear + dyNear * dyNear;
+                    float farthestSq = dxFar * dxFar + dyFar * dyFar;
+                    visit(nearestSq, farthestSq, &items_[cellStart_[cell]], &items_[cellStart_[cell + 1]]);
+                }
+            }
+        }
+
+    private:
+        int cellSize_ = GRID_CELL_SIZE;
+        int cols_ = 1;
+        int rows_ = 1;
+
+        // Item counts and indices are 32-bit so large fields can't wrap
+        std::vector<uint16_t> itemCell_;   // cell of each item, by index
+        std::vector<uint32_t> cellStart_;  // first slot of each cell in items_
+        std::vector<uint32_t> items_;      // item indices grouped by cell
+
+        float maxRadius_ = 0;
+
+        int clampCol(float x) const;
+        int clampRow(float y) const;
+        uint16_t cellIndex(float x, float y) const { return clampRow(y) * cols_ + clampCol(x); }
+        // Nearest and farthest distance from v to a cell's extent on one
+        // axis; edge cells reach to infinity since they hold clamped items.
+        void spanDistance(float v, int index, int count, float &nearest, float &farthest) const;
+};
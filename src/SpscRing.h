@@ -0,0 +1,40 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Lock-free ring between one producer and one consumer. Each index is
+// written by one side only, so pushing and popping never need a critical
+// section. Holds N - 1 items; N must be a power of two.
+template <typename T, uint8_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+    public:
+        // Producer side; returns false, dropping item, when the ring is full
+        bool push(const T &item) {
+            uint8_t head = head_.load(std::memory_order_relaxed);
+            uint8_t next = (head + 1) & (N - 1);
+            if (next == tail_.load(std::memory_order_acquire)) return false;
+            items_[head] = item;
+            head_.store(next, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side
+        bool pop(T &out) {
+            uint8_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail == head_.load(std::memory_order_acquire)) return false;
+            out = items_[tail];
+            tail_.store((tail + 1) & (N - 1), std::memory_order_release);
+            return true;
+        }
+
+        bool empty() const {
+            return tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_acquire);
+        }
+
+    private:
+        T items_[N];
+        std::atomic<uint8_t> head_{0};
+        std::atomic<uint8_t> tail_{0};
+};
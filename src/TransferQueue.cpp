@@ -0,0 +1,112 @@
+#include "TransferQueue.h"
+#include "PinnedTask.h"
+
+void LgfxSpanBus::begin() {
+    // Keep the bus transaction open; endWrite() would wait for DMA to drain
+    lcd_.startWrite();
+}
+
+void LgfxSpanBus::push(int x, int y, int len, const uint16_t *pixels) {
+    lcd_.pushImageDMA(x, y, len, 1, pixels);
+}
+
+bool LgfxSpanBus::busy() {
+    return lcd_.dmaBusy();
+}
+
+void LgfxSpanBus::wait() {
+    lcd_.waitDMA();
+}
+
+bool TransferQueue::startPushTask(int core) {
+    if (pushTask_) return true;
+    pushTask_ = true;
+    if (startPinnedTask("pond-push", core, pushTask, this)) return true;
+    pushTask_ = false;
+    return false;
+}
+
+void TransferQueue::pushTask(void *arg) {
+    TransferQueue *self = static_cast<TransferQueue*>(arg);
+    for (;;) {
+        // Spin while a transfer runs; spans are microseconds long
+        if (self->bus_.busy()) continue;
+        self->retireInFlight();
+        if (!self->startNext()) yieldTask();
+    }
+}
+
+void TransferQueue::enqueue(uint8_t source, int x, int y, int len, const uint16_t *pixels) {
+    push(source, x, y, len, pixels, nullptr);
+}
+
+void TransferQueue::enqueue(uint8_t source, int x, int y, int len, const uint8_t *indices, const Palette &palette) {
+    while (len > TRANSFER_EXPAND_PIXELS) {
+        push(source, x, y, TRANSFER_EXPAND_PIXELS, indices, &palette);
+        x += TRANSFER_EXPAND_PIXELS;
+        indices += TRANSFER_EXPAND_PIXELS;
+        len -= TRANSFER_EXPAND_PIXELS;
+    }
+    push(source, x, y, len, indices, &palette);
+}
+
+void TransferQueue::push(uint8_t source, int x, int y, int len, const void *pixels, const Palette *palette) {
+    while (pending() == TRANSFER_QUEUE_SIZE) waitForBus();
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    spans_[head & (TRANSFER_QUEUE_SIZE - 1)] = {pixels, palette, (int16_t)x, (int16_t)y, (int16_t)len, source};
+    outstanding_[source].fetch_add(1, std::memory_order_relaxed);
+    head_.store(head + 1, std::memory_order_release);
+    queuedSpans_++;
+    queuedPixels_ += len;
+    pump();
+}
+
+void TransferQueue::pump() {
+    if (pushTask_) return;
+    while (!bus_.busy()) {
+        retireInFlight();
+        if (!startNext()) return;
+    }
+}
+
+void TransferQueue::fence(uint8_t source) {
+    while (outstanding_[source].load(std::memory_order_acquire) > 0) waitForBus();
+}
+
+void TransferQueue::flush() {
+    for (int source = 0; source < TRANSFER_SOURCES; source++) fence(source);
+}
+
+void TransferQueue::waitForBus() {
+    if (pushTask_) {
+        spinWait();
+        return;
+    }
+    bus_.wait();
+    retireInFlight();
+    startNext();
+}
+
+void TransferQueue::retireInFlight() {
+    if (inFlight_ < 0) return;
+    // Releases the span's pixels to whoever is fencing its source
+    outstanding_[inFlight_].fetch_sub(1, std::memory_order_release);
+    inFlight_ = -1;
+}
+
+bool TransferQueue::startNext() {
+    if (inFlight_ >= 0) return false;
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) return false;
+    const Span s = spans_[tail & (TRANSFER_QUEUE_SIZE - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    inFlight_ = s.source;
+    if (!s.palette) {
+        bus_.push(s.x, s.y, s.len, (const uint16_t*)s.pixels);
+        return true;
+    }
+    // The previous span has left the bus, so its expansion can be reused
+    s.palette->expand((const uint8_t*)s.pixels, s.len, expanded_);
+    bus_.push(s.x, s.y, s.len, expanded_);
+    return true;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <Arduino.h>
+#include <LovyanGFX.hpp>
+#include <atomic>
+#include "animation/Palette.h"
+
+#define TRANSFER_QUEUE_SIZE 512
+#define TRANSFER_SOURCES 2
+// Longest indexed span expanded at once; longer ones are queued in pieces
+#define TRANSFER_EXPAND_PIXELS 320
+
+// Something that can stream a row of pixels to the panel in the background.
+// Kept abstract so the queue and its fencing can run against a mock bus.
+class SpanBus {
+    public:
+        virtual ~SpanBus() = default;
+        virtual void begin() {}
+        // Starts a transfer; `pixels` must stay untouched until !busy()
+        virtual void push(int x, int y, int len, const uint16_t *pixels) = 0;
+        virtual bool busy() = 0;
+        virtual void wait() = 0;
+};
+
+// Streams spans through LovyanGFX's DMA path (dma_channel in config.hpp).
+class LgfxSpanBus : public SpanBus {
+    public:
+        explicit LgfxSpanBus(LGFX_Device &lcd) : lcd_(lcd) {}
+
+        void begin() override;
+        void push(int x, int y, int len, const uint16_t *pixels) override;
+        bool busy() override;
+        void wait() override;
+
+    private:
+        LGFX_Device &lcd_;
+};
+
+// FIFO of changed spans waiting for the bus. Each span remembers which
+// framebuffer it reads from so that buffer can be fenced before reuse.
+// Spans of palette indices are expanded to RGB565 only as they go out.
+//
+// The bus is fed either by whoever calls pump(), or, after startPushTask(),
+// by a task of its own that starts each span as the previous one completes.
+// The queue is lock-free between the enqueuing side and the bus side.
+class TransferQueue {
+    public:
+        explicit TransferQueue(SpanBus &bus) : bus_(bus) {}
+
+        void begin() { bus_.begin(); }
+        // Hands the bus to a task pinned to `core`, which then owns it for
+        // good; pump() does nothing from then on. Call after begin().
+        bool startPushTask(int core);
+
+        void enqueue(uint8_t source, int x, int y, int len, const uint16_t *pixels);
+        // Indices into palette, which must stay unchanged while they're queued
+        void enqueue(uint8_t source, int x, int y, int len, const uint8_t *indices, const Palette &palette);
+
+        // Starts queued spans while the bus is idle; never blocks
+        void pump();
+        // Blocks until nothing queued or in flight reads from `source`
+        void fence(uint8_t source);
+        // Blocks until every span is on the panel
+        void flush();
+
+        // Spans not yet started
+        size_t pending() const {
+            return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+        }
+        // Running totals since begin(), one span per push
+        uint32_t queuedSpans() const { return queuedSpans_; }
+        uint32_t queuedPixels() const { return queuedPixels_; }
+
+    private:
+        struct Span {
+            const void *pixels;
+            // Set for spans of palette indices
+            const Palette *palette;
+            int16_t x;
+            int16_t y;
+            int16_t len;
+            uint8_t source;
+        };
+
+        static_assert((TRANSFER_QUEUE_SIZE & (TRANSFER_QUEUE_SIZE - 1)) == 0,
+                      "TRANSFER_QUEUE_SIZE must be a power of two");
+
+        SpanBus &bus_;
+        bool pushTask_ = false;
+        Span spans_[TRANSFER_QUEUE_SIZE];
+        // Free-running counts; head_ is only written when enqueuing, tail_
+        // only on the bus side
+        std::atomic<uint32_t> head_{0};
+        std::atomic<uint32_t> tail_{0};
+        uint32_t queuedSpans_ = 0;
+        uint32_t queuedPixels_ = 0;
+
+        // Spans per source that are queued or on the wire
+        std::atomic<uint16_t> outstanding_[TRANSFER_SOURCES] = {};
+        // Bus side only
+        int8_t inFlight_ = -1;
+        // The in-flight span, if indexed, expanded; only one is ever on the bus
+        uint16_t expanded_[TRANSFER_EXPAND_PIXELS];
+
+        void push(uint8_t source, int x, int y, int len, const void *pixels, const Palette *palette);
+        // One step of a blocking wait: drives the bus itself, or lets the
+        // push task do it
+        void waitForBus();
+
+        void retireInFlight();
+        bool startNext();
+        static void pushTask(void *arg);
+};
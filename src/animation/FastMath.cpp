@@ -0,0 +1,31 @@
+#include "FastMath.h"
+
+#define FM_PI 3.14159265358979323846f
+#define FM_HALF_PI 1.57079632679489661923f
+
+float fastAtan2(float y, float x) {
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    if (ax == 0 && ay == 0) return 0.0f;
+
+    // atan on [0, 1] (Abramowitz & Stegun 4.4.49), then unfold the octant
+    bool steep = ay > ax;
+    float z = steep ? ax / ay : ay / ax;
+    float z2 = z * z;
+    float a = z * (0.9998660f + z2 * (-0.3302995f + z2 * (0.1801410f + z2 * (-0.0851330f + z2 * 0.0208351f))));
+
+    if (steep) a = FM_HALF_PI - a;
+    if (x < 0) a = FM_PI - a;
+    return y < 0 ? -a : a;
+}
+
+float fastAcos(float x) {
+    if (x > 1.0f) x = 1.0f;
+    if (x < -1.0f) x = -1.0f;
+
+    // Abramowitz & Stegun 4.4.45, mirrored for negative input
+    float ax = fabsf(x);
+    float root = sqrtf(1.0f - ax);
+    float a = root * (1.5707288f + ax * (-0.2121144f + ax * (0.0742610f + ax * -0.0187293f)));
+    return x < 0 ? FM_PI - a : a;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Polynomial approximations of the libm calls used on the animation hot
+// paths. Max absolute error against double libm; `--micro math` holds each
+// under 0.1 px at the longest joint lever (2.4e-4):
+//   fastAtan2          1.2e-5 rad
+//   fastAcos           6.8e-5 rad
+//   fastInvSqrt        4.8e-6 relative
+float fastAtan2(float y, float x);
+float fastAcos(float x);
+
+inline float fastInvSqrt(float x) {
+    // Bit-level initial guess refined by two Newton steps
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    bits = 0x5f3759df - (bits >> 1);
+    float y;
+    memcpy(&y, &bits, sizeof(y));
+    y = y * (1.5f - 0.5f * x * y * y);
+    y = y * (1.5f - 0.5f * x * y * y);
+    return y;
+}
+
+// Sine and cosine of one angle together, for |radian| <= PI, without a
+// libm call: Taylor series on a quarter of the angle, then two doublings.
+// Max absolute error 2.3e-6. Used regardless of POND_FAST_MATH.
+inline void polySinCos(float radian, float &s, float &c) {
+    float x = radian * 0.25f;
+    float x2 = x * x;
+    s = x * (1.0f + x2 * (-1.0f / 6 + x2 * (1.0f / 120 + x2 * (-1.0f / 5040))));
+    c = 1.0f + x2 * (-0.5f + x2 * (1.0f / 24 + x2 * (-1.0f / 720 + x2 * (1.0f / 40320))));
+    for (int i = 0; i < 2; i++) {
+        float s2 = 2.0f * s * c;
+        c = 1.0f - 2.0f * s * s;
+        s = s2;
+    }
+}
+
+// Sine and cosine stay on libm either way; a range-reduced polynomial measured
+// slower than sinf/cosf. Paired sin/cos of small angles use polySinCos.
+inline float mathSin(float radian) { return sinf(radian); }
+inline float mathCos(float radian) { return cosf(radian); }
+
+// Callers go through these so -DPOND_FAST_MATH switches the whole tree
+#ifdef POND_FAST_MATH
+inline float mathAtan2(float y, float x) { return fastAtan2(y, x); }
+inline float mathAcos(float x) { return fastAcos(x); }
+inline float mathInvSqrt(float x) { return fastInvSqrt(x); }
+inline float mathSqrt(float x) { return x > 0 ? x * fastInvSqrt(x) : 0.0f; }
+#else
+inline float mathAtan2(float y, float x) { return atan2f(y, x); }
+inline float mathAcos(float x) { return acosf(x); }
+inline float mathInvSqrt(float x) { return 1.0f / sqrtf(x); }
+inline float mathSqrt(float x) { return sqrtf(x); }
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+#include <stddef.h>
+
+// Vector-like container with inline storage and a fixed capacity, so the
+// frame loop never touches the heap. Adding to a full container fails and
+// returns false instead of growing. Removal keeps the remaining order.
+template <typename T, int Capacity>
+class FixedVector {
+    public:
+        FixedVector() = default;
+        FixedVector(const FixedVector &other) { *this = other; }
+        FixedVector& operator=(const FixedVector &other) {
+            // Only the live elements are copied
+            count_ = other.count_;
+            for (int i = 0; i < count_; i++) items_[i] = other.items_[i];
+            return *this;
+        }
+
+        bool push_back(const T &item) {
+            if (count_ >= Capacity) return false;
+            items_[count_++] = item;
+            return true;
+        }
+
+        template <typename... Args>
+        bool emplace_back(Args&&... args) {
+            if (count_ >= Capacity) return false;
+            items_[count_++] = T(static_cast<Args&&>(args)...);
+            return true;
+        }
+
+        // Appends as many of other's elements as fit
+        void append(const FixedVector &other) {
+            for (int i = 0; i < other.count_ && count_ < Capacity; i++) items_[count_++] = other.items_[i];
+        }
+
+        // Drops every element for which remove(element) is true, in one pass
+        template <typename Predicate>
+        void removeIf(Predicate remove) {
+            int kept = 0;
+            for (int i = 0; i < count_; i++) {
+                if (remove(items_[i])) continue;
+                if (kept != i) items_[kept] = items_[i];
+                kept++;
+            }
+            count_ = kept;
+        }
+
+        void clear() { count_ = 0; }
+        size_t size() const { return (size_t)count_; }
+        bool empty() const { return count_ == 0; }
+        bool full() const { return count_ >= Capacity; }
+        static constexpr int capacity() { return Capacity; }
+
+        T& operator[](size_t index) { return items_[index]; }
+        const T& operator[](size_t index) const { return items_[index]; }
+        T* begin() { return items_; }
+        T* end() { return items_ + count_; }
+        const T* begin() const { return items_; }
+        const T* end() const { return items_ + count_; }
+
+    private:
+        T items_[Capacity];
+        int count_ = 0;
+};
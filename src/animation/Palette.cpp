@@ -0,0 +1,36 @@
+#include "Palette.h"
+
+void Palette::begin(bool indexed) {
+    indexed_ = indexed;
+    for (int i = 0; i < PALETTE_SIZE; i++) colors_[i] = panel_[i] = 0;
+    count_ = 1;
+}
+
+uint16_t Palette::ink(uint16_t color) {
+    if (!indexed_) return color;
+    for (int i = 0; i < count_; i++) {
+        if (colors_[i] == color) return i;
+    }
+    if (count_ == PALETTE_SIZE) return nearest(color);
+    colors_[count_] = color;
+    panel_[count_] = (uint16_t)((color >> 8) | (color << 8));
+    return count_++;
+}
+
+// Closest entry by squared distance over the 5/6/5-bit channels
+int Palette::nearest(uint16_t color) const {
+    int r = color >> 11, g = (color >> 5) & 0x3F, b = color & 0x1F;
+    int best = 0;
+    int bestDistance = 1 << 30;
+    for (int i = 0; i < count_; i++) {
+        int dr = (colors_[i] >> 11) - r;
+        int dg = ((colors_[i] >> 5) & 0x3F) - g;
+        int db = (colors_[i] & 0x1F) - b;
+        int distance = dr * dr + dg * dg + db * db;
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = i;
+        }
+    }
+    return best;
+}
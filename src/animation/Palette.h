@@ -0,0 +1,33 @@
+#pragma once
+#include <stdint.h>
+
+#define PALETTE_SIZE 256
+
+// The colours the scene draws with, for 8-bit indexed framebuffers. Entities
+// are handed ink() values at set-up: palette indices when indexed, plain
+// RGB565 otherwise, so their drawing code is the same either way. Index 0 is
+// black, so clearing a sprite to 0 is black in both modes.
+class Palette {
+    public:
+        // Forgets every colour but black
+        void begin(bool indexed);
+        bool indexed() const { return indexed_; }
+        int size() const { return count_; }
+
+        // Sprite colour for an RGB565 colour: its index, added on first use,
+        // or the nearest entry once the palette is full
+        uint16_t ink(uint16_t color);
+
+        // Writes count pixels as byte-swapped RGB565, ready for the panel
+        void expand(const uint8_t *indices, int count, uint16_t *out) const {
+            for (int i = 0; i < count; i++) out[i] = panel_[indices[i]];
+        }
+
+    private:
+        bool indexed_ = false;
+        int count_ = 0;
+        uint16_t colors_[PALETTE_SIZE];
+        uint16_t panel_[PALETTE_SIZE];
+
+        int nearest(uint16_t color) const;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+// Small xorshift32 generator. Each entity or subsystem owns one, seeded
+// from the scene seed, so a pond replays identically on host and device
+// and nothing shares libc's global rand() state across cores.
+class Random {
+    public:
+        explicit Random(uint32_t seed = 1) { reseed(seed); }
+
+        // Any seed works, 0 included; it is scrambled before use
+        void reseed(uint32_t seed) {
+            // splitmix32 finaliser; xorshift must never hold 0
+            seed += 0x9E3779B9u;
+            seed = (seed ^ (seed >> 16)) * 0x85EBCA6Bu;
+            seed = (seed ^ (seed >> 13)) * 0xC2B2AE35u;
+            seed ^= seed >> 16;
+            state_ = seed ? seed : 0x6D2B79F5u;
+        }
+
+        uint32_t next() {
+            uint32_t x = state_;
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            state_ = x;
+            return x;
+        }
+
+        // Uniform in [0, 1): the top 23 bits become the mantissa of a float
+        // in [1, 2), so no division is needed
+        float nextFloat() {
+            uint32_t bits = 0x3F800000u | (next() >> 9);
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            return f - 1.0f;
+        }
+
+        // Uniform in [minValue, maxValue)
+        float range(float minValue, float maxValue) {
+            return minValue + (maxValue - minValue) * nextFloat();
+        }
+
+        // Uniform in [0, bound) for bound > 0
+        uint32_t below(uint32_t bound) {
+            return (uint32_t)(((uint64_t)next() * bound) >> 32);
+        }
+
+        // Seed for a child generator, so subsystems get independent streams
+        uint32_t fork() { return next(); }
+
+    private:
+        uint32_t state_;
+};
@@ -0,0 +1,165 @@
+#include "SpanFill.h"
+
+namespace {
+
+struct RowCrossings {
+    uint8_t count;
+    int16_t x[SPAN_MAX_CROSSINGS];
+    int8_t winding[SPAN_MAX_CROSSINGS];
+};
+
+// Scratch shared by all fills; only the render path draws.
+RowCrossings rows[SPAN_MAX_ROWS];
+// Set when a row of the current fill ran out of crossing slots
+bool rowsOverflowed = false;
+uint32_t overflowCount = 0;
+
+// Records where the edge a->b crosses each row in [top, bottom]. Rows are
+// half-open per edge so shared vertices are not counted twice.
+void addEdge(int xa, int ya, int xb, int yb, int top, int bottom) {
+    if (ya == yb) return;
+    int8_t winding = 1;
+    if (ya > yb) {
+        int t = ya; ya = yb; yb = t;
+        t = xa; xa = xb; xb = t;
+        winding = -1;
+    }
+    int yFrom = ya > top ? ya : top;
+    int yTo = yb - 1 < bottom ? yb - 1 : bottom;
+    if (yFrom > yTo) return;
+
+    int dx = xb - xa;
+    int dy = yb - ya;
+    int step = (yFrom - ya) * dx;
+    for (int y = yFrom; y <= yTo; y++, step += dx) {
+        RowCrossings &row = rows[y - top];
+        if (row.count == SPAN_MAX_CROSSINGS) {
+            rowsOverflowed = true;
+            continue;
+        }
+        // Insertion keeps the row sorted; there are only a handful per row
+        int x = xa + step / dy;
+        int i = row.count++;
+        while (i > 0 && row.x[i - 1] > x) {
+            row.x[i] = row.x[i - 1];
+            row.winding[i] = row.winding[i - 1];
+            i--;
+        }
+        row.x[i] = x;
+        row.winding[i] = winding;
+    }
+}
+
+} // namespace
+
+void writeSpan(LGFX_Sprite* sprite, int y, int x0, int x1, uint16_t color) {
+    int32_t cx, cy, cw, ch;
+    sprite->getClipRect(&cx, &cy, &cw, &ch);
+    if (y < cy || y >= cy + ch) return;
+    if (x0 < cx) x0 = cx;
+    if (x1 > cx + cw - 1) x1 = cx + cw - 1;
+    if (x0 > x1) return;
+
+    if (sprite->getColorDepth() == lgfx::palette_8bit) {
+        memset((uint8_t*)sprite->getBuffer() + y * sprite->width() + x0, (uint8_t)color, x1 - x0 + 1);
+        return;
+    }
+    if (sprite->getColorDepth() != 16) {
+        sprite->drawFastHLine(x0, y, x1 - x0 + 1, color);
+        return;
+    }
+    // 16-bit sprites keep pixels byte-swapped, ready for the panel
+    uint16_t raw = (uint16_t)((color >> 8) | (color << 8));
+    uint16_t* p = (uint16_t*)sprite->getBuffer() + y * sprite->width() + x0;
+    for (int x = x0; x <= x1; x++) *p++ = raw;
+}
+
+void fillStrip(LGFX_Sprite* sprite, const Point *left, const Point *right, int count, uint16_t color) {
+    if (count < 2) return;
+
+    int32_t cx, cy, cw, ch;
+    sprite->getClipRect(&cx, &cy, &cw, &ch);
+
+    int top = (int)left[0].y;
+    int bottom = top;
+    for (int i = 0; i < count; i++) {
+        int yl = (int)left[i].y;
+        int yr = (int)right[i].y;
+        if (yl < top) top = yl;
+        if (yr < top) top = yr;
+        if (yl > bottom) bottom = yl;
+        if (yr > bottom) bottom = yr;
+    }
+    if (top < cy) top = cy;
+    if (bottom > cy + ch - 1) bottom = cy + ch - 1;
+    if (top > bottom) return;
+    if (bottom - top >= SPAN_MAX_ROWS) bottom = top + SPAN_MAX_ROWS - 1;
+
+    for (int y = top; y <= bottom; y++) rows[y - top].count = 0;
+    rowsOverflowed = false;
+
+    // Walk the closed outline: down the left side, back up the right
+    int px = (int)right[0].x;
+    int py = (int)right[0].y;
+    for (int i = 0; i < count; i++) {
+        int x = (int)left[i].x, y = (int)left[i].y;
+        addEdge(px, py, x, y, top, bottom);
+        px = x; py = y;
+    }
+    for (int i = count - 1; i >= 0; i--) {
+        int x = (int)right[i].x, y = (int)right[i].y;
+        addEdge(px, py, x, y, top, bottom);
+        px = x; py = y;
+    }
+
+    // A strip coiled tightly enough to cross a row more often than the
+    // slots allow would lose spans; draw it as triangle pairs instead
+    if (rowsOverflowed) {
+        overflowCount++;
+        for (int i = 0; i < count - 1; i++) {
+            sprite->fillTriangle((int)left[i].x, (int)left[i].y, (int)right[i].x, (int)right[i].y,
+                                 (int)left[i + 1].x, (int)left[i + 1].y, color);
+            sprite->fillTriangle((int)right[i].x, (int)right[i].y, (int)left[i + 1].x, (int)left[i + 1].y,
+                                 (int)right[i + 1].x, (int)right[i + 1].y, color);
+        }
+        return;
+    }
+
+    int xMin = cx;
+    int xMax = cx + cw - 1;
+    bool direct = sprite->getColorDepth() == 16;
+    bool indexed = sprite->getColorDepth() == lgfx::palette_8bit;
+    uint16_t raw = (uint16_t)((color >> 8) | (color << 8));
+    int width = sprite->width();
+    uint16_t* line = (uint16_t*)sprite->getBuffer() + top * width;
+    uint8_t* line8 = (uint8_t*)sprite->getBuffer() + top * width;
+
+    for (int y = top; y <= bottom; y++, line += width, line8 += width) {
+        const RowCrossings &row = rows[y - top];
+        int winding = 0;
+        int start = 0;
+        for (int i = 0; i < row.count; i++) {
+            int before = winding;
+            winding += row.winding[i];
+            if (before == 0 && winding != 0) {
+                start = row.x[i];
+            } else if (before != 0 && winding == 0) {
+                // Spans already clipped vertically; clamp horizontally
+                int a = start < xMin ? xMin : start;
+                int b = row.x[i] > xMax ? xMax : row.x[i];
+                if (a > b) continue;
+                if (direct) {
+                    for (int x = a; x <= b; x++) line[x] = raw;
+                } else if (indexed) {
+                    memset(line8 + a, (uint8_t)color, b - a + 1);
+                } else {
+                    sprite->drawFastHLine(a, y, b - a + 1, color);
+                }
+            }
+        }
+    }
+}
+
+uint32_t fillStripOverflows() {
+    return overflowCount;
+}
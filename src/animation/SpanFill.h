@@ -0,0 +1,23 @@
+#pragma once
+#include "helper.h"
+
+// Rows covered by one fill; large enough for either screen orientation.
+#define SPAN_MAX_ROWS 320
+// Outline crossings kept per row; a bent fish body needs four at most.
+// Fills that need more fall back to triangles; see fillStripOverflows().
+#define SPAN_MAX_CROSSINGS 8
+
+// Writes pixels x0..x1 of row y straight into the sprite buffer, clipped to
+// the sprite's clip rect. 16-bit and 8-bit palette sprites are written
+// directly; other depths fall back to drawFastHLine.
+void writeSpan(LGFX_Sprite* sprite, int y, int x0, int x1, uint16_t color);
+
+// Fills the strip between two outlines of `count` points each in a single
+// scanline pass over its boundary (left[0..n-1] then right[n-1..0]), so
+// every pixel is written once. Uses the nonzero rule, which keeps twisted
+// segments filled.
+void fillStrip(LGFX_Sprite* sprite, const Point *left, const Point *right, int count, uint16_t color);
+
+// Fills so far that crossed some row more than SPAN_MAX_CROSSINGS times and
+// were drawn as triangle pairs instead
+uint32_t fillStripOverflows();
@@ -0,0 +1,128 @@
+#include "Stamp.h"
+
+// Placeholder colors used while rasterizing; the background key is picked
+// so it never clashes with them.
+#define RASTER_FILL 0x07E0
+#define RASTER_STROKE 0xF800
+#define RASTER_KEY 0x001F
+
+static void drawClosedCurve(LGFX_Sprite* sprite, Point anchor, const Point *points, int len) {
+    Point pLast = points[len - 1];
+    Point pStart = { (points[0].x + pLast.x)/2.0f, (points[0].y + pLast.y)/2.0f };
+    Point pEnd = points[len - 1];
+
+    // 1. Fill Shape
+    Point currentP = pStart;
+    for (int i = 0; i < len - 1; i++) {
+        Point p1 = points[i];
+        Point p2 = points[i+1];
+        Point mid = { (p1.x + p2.x)/2.0f, (p1.y + p2.y)/2.0f };
+        fillQuadraticBezier(sprite, anchor, currentP.x, currentP.y, p1.x, p1.y, mid.x, mid.y, RASTER_FILL);
+        currentP = mid;
+    }
+    fillQuadraticBezier(sprite, anchor, currentP.x, currentP.y, pEnd.x, pEnd.y, pStart.x, pStart.y, RASTER_FILL);
+
+    // 2. Stroke Outline
+    currentP = pStart;
+    for (int i = 0; i < len - 1; i++) {
+        Point p1 = points[i];
+        Point p2 = points[i+1];
+        Point mid = { (p1.x + p2.x)/2.0f, (p1.y + p2.y)/2.0f };
+        drawQuadraticBezier(sprite, currentP.x, currentP.y, p1.x, p1.y, mid.x, mid.y, RASTER_STROKE);
+        currentP = mid;
+    }
+    drawQuadraticBezier(sprite, currentP.x, currentP.y, pEnd.x, pEnd.y, pStart.x, pStart.y, RASTER_STROKE);
+}
+
+std::shared_ptr<const Stamp> Stamp::fromOutline(const Point *outline, int count) {
+    return std::make_shared<const Stamp>(rasterize(outline, count));
+}
+
+Stamp Stamp::rasterize(const Point *outline, int count) {
+    Stamp stamp;
+    if (count < 2) return stamp;
+
+    float reach = 0;
+    for (int i = 0; i < count; i++) {
+        reach = fmaxf(reach, fmaxf(fabsf(outline[i].x), fabsf(outline[i].y)));
+    }
+    int c = (int)ceilf(reach) + 2;
+    if (c > 127) c = 127; // Runs store int8 offsets
+    int size = 2 * c + 1;
+
+    LGFX_Sprite canvas;
+    canvas.setColorDepth(16);
+    if (!canvas.createSprite(size, size)) return stamp;
+    canvas.fillScreen(RASTER_KEY);
+
+    std::vector<Point> points(count);
+    for (int i = 0; i < count; i++) points[i] = {outline[i].x + c, outline[i].y + c};
+    drawClosedCurve(&canvas, {(float)c, (float)c}, points.data(), count);
+
+    // Collect runs of equal ink, left to right, top to bottom
+    bool any = false;
+    for (int y = 0; y < size; y++) {
+        int x = 0;
+        while (x < size) {
+            uint16_t color = canvas.readPixel(x, y);
+            if (color != RASTER_FILL && color != RASTER_STROKE) { x++; continue; }
+            int start = x;
+            while (x < size && x - start < 255 && canvas.readPixel(x, y) == color) x++;
+
+            uint8_t ink = (color == RASTER_STROKE) ? STAMP_STROKE : STAMP_FILL;
+            stamp.runs_.push_back({(int8_t)(start - c), (int8_t)(y - c), (uint8_t)(x - start), ink});
+
+            if (!any || start - c < stamp.left_) stamp.left_ = start - c;
+            if (!any || x - 1 - c > stamp.right_) stamp.right_ = x - 1 - c;
+            if (!any) stamp.top_ = y - c;
+            stamp.bottom_ = y - c;
+            any = true;
+        }
+    }
+    stamp.runs_.shrink_to_fit();
+    return stamp;
+}
+
+void Stamp::draw(LGFX_Sprite* sprite, int x, int y, uint16_t fillColor, uint16_t strokeColor) const {
+    int32_t cx, cy, cw, ch;
+    sprite->getClipRect(&cx, &cy, &cw, &ch);
+    int xMax = cx + cw - 1;
+    int yMax = cy + ch - 1;
+    if (x + right_ < cx || x + left_ > xMax || y + bottom_ < cy || y + top_ > yMax) return;
+
+    bool direct = sprite->getColorDepth() == 16;
+    bool indexed = sprite->getColorDepth() == lgfx::palette_8bit;
+    // 16-bit sprites keep pixels byte-swapped, ready for the panel
+    uint16_t raw[2] = {
+        (uint16_t)((fillColor >> 8) | (fillColor << 8)),
+        (uint16_t)((strokeColor >> 8) | (strokeColor << 8))
+    };
+    uint16_t color[2] = {fillColor, strokeColor};
+    uint16_t* buffer = (uint16_t*)sprite->getBuffer();
+    int width = sprite->width();
+
+    for (const auto& run : runs_) {
+        int py = y + run.dy;
+        if (py < cy || py > yMax) continue;
+        int a = x + run.dx;
+        int b = a + run.len - 1;
+        if (a < cx) a = cx;
+        if (b > xMax) b = xMax;
+        if (a > b) continue;
+
+        if (direct) {
+            uint16_t* p = buffer + py * width;
+            uint16_t value = raw[run.ink];
+            for (int px = a; px <= b; px++) p[px] = value;
+        } else if (indexed) {
+            memset((uint8_t*)buffer + py * width + a, (uint8_t)color[run.ink], b - a + 1);
+        } else {
+            sprite->drawFastHLine(a, py, b - a + 1, color[run.ink]);
+        }
+    }
+}
+
+Rect Stamp::bounds(int x, int y) const {
+    if (runs_.empty()) return emptyRect();
+    return {x + left_, y + top_, x + right_ + 1, y + bottom_ + 1};
+}
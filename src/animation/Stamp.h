@@ -0,0 +1,36 @@
+#pragma once
+#include "helper.h"
+#include <memory>
+#include <vector>
+
+// One horizontal run of a stamp, relative to the stamp origin
+struct StampRun {
+    int8_t dx;
+    int8_t dy;
+    uint8_t len;
+    uint8_t ink; // STAMP_FILL or STAMP_STROKE
+};
+
+#define STAMP_FILL 0
+#define STAMP_STROKE 1
+
+// A shape rasterized once and then blitted at integer positions. Only the
+// fill/stroke classification is stored, so the colors stay with the owner.
+class Stamp {
+    public:
+        // Rasterizes the smooth closed curve through `outline` (relative to
+        // the origin), filled from the origin and stroked, like the old
+        // per-frame Leaf/DuckWeed drawing.
+        static Stamp rasterize(const Point *outline, int count);
+        static std::shared_ptr<const Stamp> fromOutline(const Point *outline, int count);
+
+        void draw(LGFX_Sprite* sprite, int x, int y, uint16_t fillColor, uint16_t strokeColor) const;
+        Rect bounds(int x, int y) const;
+
+    private:
+        std::vector<StampRun> runs_;
+        int left_ = 0;
+        int top_ = 0;
+        int right_ = 0;
+        int bottom_ = 0;
+};
@@ -1,89 +1,179 @@
 #include "Chain.h"
+#include "../SpanFill.h"
+#include "FishSpecies.h"
 
-Chain::Chain(float x, float y, float gap, float angle, const std::vector<float>& sizes)
-    : x_(x), y_(y), gap_(gap)
+template <int N>
+Chain<N>::Chain(Circle *fishJoints, int offset, float x, float y, float gap, float angle, const float (&sizes)[N])
+    : gap_(gap), offset_(offset)
 {
     smallestAngle_ = (angle * PI) / 180.0f;
-    length_ = sizes.size();
-    if(length_ > MAX_CHAIN_LENGTH) length_ = MAX_CHAIN_LENGTH;
+    bind(fishJoints);
 
-    for (int i = 0; i < length_; ++i) {
+    for (int i = 0; i < N; ++i) {
         // sizes[i] in TS is diameter, Circle takes radius
-        circles_[i] = Circle(x_, y_, sizes[i] / 2.0f);
-        x_ += gap;
+        circles_[i] = Circle(x, y, sizes[i] / 2.0f);
+        x += gap;
     }
+
+    // Link i swings with phase frameCount_ + i * phaseStep
+    float phaseStep = N * PI * 1.1368f;
+    cosSmallest_ = mathCos(smallestAngle_);
+    sinSmallest_ = mathSin(smallestAngle_);
+    cosPhaseStep_ = mathCos(phaseStep);
+    sinPhaseStep_ = mathSin(phaseStep);
 }
 
-void Chain::freeMove(float x, float y, int width, int height) {
-    float acceleration = circles_[0].followPoint(x, y, width, height);
-    frameCount_ += 25.0f * log(0.3f * acceleration + 1.0f);
+// Cheap stand-in for atan2, within 0.004 rad, for the joint easing only;
+// that term is scaled by 0.001, so the error never reaches a pixel
+static float coarseAtan2(float y, float x) {
+    float ax = fabsf(x);
+    float ay = fabsf(y);
+    if (ax == 0 && ay == 0) return 0.0f;
 
-    float oscillateScale = (PI / 5.0f) * log(2.0f * acceleration + 1.0f);
+    bool steep = ay > ax;
+    float z = steep ? ax / ay : ay / ax;
+    float a = z * (0.25f * PI + 0.273f * (1.0f - z));
+    if (steep) a = 0.5f * PI - a;
+    if (x < 0) a = PI - a;
+    return y < 0 ? -a : a;
+}
 
-    for (int i = 1; i < length_; i++) {
-        float oscillateOffset = i * length_ * PI * 1.1368f;
-        float mapVal = map((float)i, 0.0f, (float)length_, 0.5f, 3.0f);
-        
-        float oscillateRadian = sin(frameCount_ + oscillateOffset) * oscillateScale * mapVal;
+template <int N>
+template <int First>
+void Chain<N>::followLinks(float oscillateScale) {
+    // sin/cos of the wave phase at link First, stepped by rotation
+    float phaseSin = 0.0f, phaseCos = 1.0f;
+    if (oscillateScale != 0.0f) {
+        float phase = frameCount_ + First * N * PI * 1.1368f;
+        phaseSin = mathSin(phase);
+        phaseCos = mathCos(phase);
+    }
+    constexpr float invLength = 1.0f / N;
 
-        Circle* targetOfTarget = (i >= 2) ? &circles_[i - 2] : nullptr;
-        
-        circles_[i].followBody(circles_[i - 1], targetOfTarget, gap_, smallestAngle_, &oscillateRadian);
+    // The last two placed joints ride along in locals rather than being
+    // read back from the store
+    Point target = circles_[First - 1].getPosition();
+    Point other = First >= 2 ? circles_[First - 2].getPosition() : target;
+
+    for (int i = First; i < N; i++) {
+        Point self = circles_[i].getPosition();
+
+        // Pull: keep the direction from the target, rescaled to the gap
+        Point offset = normalizeVector({self.x - target.x, self.y - target.y}, gap_);
+        if (oscillateScale != 0.0f) {
+            float oscillateRadian = phaseSin * oscillateScale * (0.5f + 2.5f * i * invLength);
+            float s, c;
+            polySinCos(oscillateRadian, s, c);
+            offset = { offset.x * c - offset.y * s, offset.x * s + offset.y * c };
+
+            float nextSin = phaseSin * cosPhaseStep_ + phaseCos * sinPhaseStep_;
+            phaseCos = phaseCos * cosPhaseStep_ - phaseSin * sinPhaseStep_;
+            phaseSin = nextSin;
+        }
+
+        if (i >= 2) {
+            // Joint limit at the target, between this link and the one before
+            Point toOther = { other.x - target.x, other.y - target.y };
+            float lengthProductSq = (toOther.x * toOther.x + toOther.y * toOther.y)
+                                  * (offset.x * offset.x + offset.y * offset.y);
+            float cosDelta = 1.0f;
+            if (lengthProductSq != 0) {
+                cosDelta = (toOther.x * offset.x + toOther.y * offset.y) * mathInvSqrt(lengthProductSq);
+            }
+
+            // Folded tighter than the limit: pin to it, on this link's side
+            if (cosDelta > cosSmallest_) {
+                float side = toOther.x * offset.y - toOther.y * offset.x > 0 ? sinSmallest_ : -sinSmallest_;
+                Point u = normalizeVector(toOther, gap_);
+                offset = { u.x * cosSmallest_ - u.y * side, u.x * side + u.y * cosSmallest_ };
+            }
+
+            // Unless already straight, nudge by a thousandth of the raw
+            // difference between the straight and current headings
+            if (cosDelta > -1.0f) {
+                float straight = coarseAtan2(-toOther.y, -toOther.x) + PI;
+                float current = coarseAtan2(offset.y, offset.x);
+                float nudge = fabsf(straight - current) * 0.001f;
+                if (toOther.x * offset.y - toOther.y * offset.x <= 0) nudge = -nudge;
+                // Small enough for the two-term series
+                float c = 1.0f - 0.5f * nudge * nudge;
+                float s = nudge * (1.0f - nudge * nudge * (1.0f / 6));
+                offset = { offset.x * c - offset.y * s, offset.x * s + offset.y * c };
+            }
+        }
+
+        Point placed = { target.x + offset.x, target.y + offset.y };
+        circles_[i].teleport(placed.x, placed.y);
+        other = target;
+        target = placed;
     }
 }
 
-void Chain::constrainMove(float x, float y, float idealRadian, float constrainStrength) {
-    circles_[0].teleport(x, y);
-    float idealDisplaceX = gap_ * cos(idealRadian);
-    float idealDisplaceY = gap_ * sin(idealRadian);
-    Point idealPosition = { x + idealDisplaceX, y + idealDisplaceY };
-
-    Point pos0 = {x, y};
-    Point pos1 = circles_[1].getPosition();
+template <int N>
+void Chain<N>::freeMove(float x, float y, int width, int height) {
+    float acceleration = circles_[0].followPoint(x, y, width, height);
+    frameCount_ += 25.0f * log(0.3f * acceleration + 1.0f);
 
-    float deltaRadian = findAngleBetween(pos0, pos1, idealPosition);
-    float currentRadian = findTangent(pos0, pos1);
-    
-    int dir = isOnLeft(pos0, idealPosition, pos1) ? -1 : 1;
-    float radian = currentRadian + dir * deltaRadian * constrainStrength;
+    float oscillateScale = (PI / 5.0f) * log(2.0f * acceleration + 1.0f);
+    followLinks<1>(oscillateScale);
+}
 
-    float displaceX = gap_ * cos(radian);
-    float displaceY = gap_ * sin(radian);
-    
-    circles_[1].teleport(x + displaceX, y + displaceY);
+template <int N>
+void Chain<N>::constrainMove(float x, float y, const Point &idealDirection, float constrainStrength) {
+    circles_[0].teleport(x, y);
 
-    for (int i = 2; i < length_; i++) {
-        Circle* targetOfTarget = (i >= 2) ? &circles_[i - 2] : nullptr;
-        circles_[i].followBody(circles_[i - 1], targetOfTarget, gap_, smallestAngle_);
+    // Turn the second joint toward the ideal direction by a fraction of the
+    // angle between them
+    Point pos1 = circles_[1].getPosition();
+    Point offset = normalizeVector({pos1.x - x, pos1.y - y}, gap_);
+    if (constrainStrength != 0.0f) {
+        float dot = offset.x * idealDirection.x + offset.y * idealDirection.y;
+        float cross = idealDirection.x * offset.y - idealDirection.y * offset.x;
+        // Only one angle per chain, so polynomials rather than libm
+        float turn = fastAtan2(fabsf(cross), dot) * constrainStrength;
+        if (cross > 0) turn = -turn;
+        float s, c;
+        polySinCos(turn, s, c);
+        offset = { offset.x * c - offset.y * s, offset.x * s + offset.y * c };
     }
+    circles_[1].teleport(x + offset.x, y + offset.y);
+
+    followLinks<2>();
 }
 
-void Chain::simpleMove(float x, float y, int width, int height) {
+template <int N>
+void Chain<N>::simpleMove(float x, float y, int width, int height) {
     circles_[0].followPoint(x, y, width, height);
-    for (int i = 1; i < length_; i++) {
-        Circle* targetOfTarget = (i >= 2) ? &circles_[i - 2] : nullptr;
-        circles_[i].followBody(circles_[i - 1], targetOfTarget, gap_, smallestAngle_);
-    }
+    followLinks<1>();
 }
 
-Point Chain::calculatePoint(const Circle& circle, float radian) {
+template <int N>
+Point Chain<N>::calculatePoint(const Circle& circle, float radian) {
     // Circle stores radius, TS code used diameter/2. 
     // radius_ is already d/2.
     Point pos = circle.getPosition();
     float r = circle.getRadius(); 
-    return { pos.x + r * cos(radian), pos.y + r * sin(radian) };
+    return { pos.x + r * mathCos(radian), pos.y + r * mathSin(radian) };
 }
 
-void Chain::draw(LGFX_Sprite* sprite, uint16_t fillColor, uint16_t strokeColor) {
-    std::vector<Point> leftPoints;
-    std::vector<Point> rightPoints;
+template <int N>
+void Chain<N>::draw(LGFX_Sprite* sprite, uint16_t fillColor, uint16_t strokeColor, ChainDetail detail) {
+    // Scratch geometry lives on the stack, sized by the chain
+    Point leftPoints[N];
+    Point rightPoints[N];
     
-    if(length_ < 2) return;
+    if(N < 2) return;
+
+    // Clipped passes (dirty rects, bands) often touch only part of a fish;
+    // skip chains whose getDirtyRect() misses the clip
+    int32_t cx, cy, cw, ch;
+    sprite->getClipRect(&cx, &cy, &cw, &ch);
+    if (!intersects(getDirtyRect(), {cx, cy, cx + cw, cy + ch})) return;
 
     // --- 1. Calculate Geometry ---
-    for (int i = 0; i < length_; i++) {
+    for (int i = 0; i < N; i++) {
         float radian = 0;
-        if (i != 0 && i != length_ - 1) {
+        if (i != 0 && i != N - 1) {
             float radDelta = findAngleBetween(circles_[i].getPosition(), circles_[i + 1].getPosition(), circles_[i - 1].getPosition());
             float radAlpha = findTangent(circles_[i].getPosition(), circles_[i - 1].getPosition());
             if (isOnLeft(circles_[i].getPosition(), circles_[i + 1].getPosition(), circles_[i - 1].getPosition())) {
@@ -93,48 +183,42 @@ void Chain::draw(LGFX_Sprite* sprite, uint16_t fillColor, uint16_t strokeColor)
             }
         } else if (i == 0) {
             radian = findTangent(circles_[i].getPosition(), circles_[i + 1].getPosition()) + 0.5f * PI;
-        } else if (i == length_ - 1) {
+        } else if (i == N - 1) {
             radian = findTangent(circles_[i].getPosition(), circles_[i - 1].getPosition()) - 0.5f * PI;
         }
 
-        leftPoints.push_back(calculatePoint(circles_[i], radian));
-        rightPoints.push_back(calculatePoint(circles_[i], radian + PI)); // Opposite side
+        leftPoints[i] = calculatePoint(circles_[i], radian);
+        rightPoints[i] = calculatePoint(circles_[i], radian + PI); // Opposite side
     }
 
-    // --- 2. Draw Fill (Triangle Strip) ---
-    for (int i = 0; i < length_ - 1; i++) {
-        Point l1 = leftPoints[i];
-        Point r1 = rightPoints[i];
-        Point l2 = leftPoints[i+1];
-        Point r2 = rightPoints[i+1];
-
-        // Fill two triangles to form the quad between segments
-        sprite->fillTriangle((int)l1.x, (int)l1.y, (int)r1.x, (int)r1.y, (int)l2.x, (int)l2.y, fillColor);
-        sprite->fillTriangle((int)r1.x, (int)r1.y, (int)l2.x, (int)l2.y, (int)r2.x, (int)r2.y, fillColor);
-    }
+    // --- 2. Draw Fill (Scanline Strip) ---
+    fillStrip(sprite, leftPoints, rightPoints, N, fillColor);
+    if (detail == CHAIN_DETAIL_FILL) return;
 
 
     // --- 3. Draw Outline (Bezier Loop) ---
-    std::vector<Point> outlinePoints;
+    // Nose, both sides and the closing point
+    Point outlinePoints[2 * N + 2];
+    int len = 0;
     
     // Add Left side points (Head -> Tail)
     // Optional: Add Head cap point logic from TS if needed, but simple loop is usually fine
-    if(length_ > 0) {
+    if(N > 0) {
         float headRad = findTangent(circles_[0].getPosition(), circles_[1].getPosition()) - 0.5f * PI;
-        outlinePoints.push_back(calculatePoint(circles_[0], headRad)); // Nose
+        outlinePoints[len++] = calculatePoint(circles_[0], headRad); // Nose
     }
-    for(const auto& p : leftPoints) outlinePoints.push_back(p);
+    for (int i = 0; i < N; i++) outlinePoints[len++] = leftPoints[i];
 
     // Add Right side points (Tail -> Head)
-    for (int i = length_ - 1; i >= 0; i--) {
-        outlinePoints.push_back(rightPoints[i]);
+    for (int i = N - 1; i >= 0; i--) {
+        outlinePoints[len++] = rightPoints[i];
     }
     // Close the loop
-    outlinePoints.push_back(outlinePoints[0]);
+    outlinePoints[len++] = outlinePoints[0];
 
     // Draw Smooth Curve through points
-    int len = outlinePoints.size();
     if(len < 2) return;
+    int maxSegments = detail == CHAIN_DETAIL_COARSE ? BEZIER_COARSE_SEGMENTS : BEZIER_MAX_SEGMENTS;
     
     Point pStart = { (outlinePoints[0].x + outlinePoints[1].x)/2.0f, (outlinePoints[0].y + outlinePoints[1].y)/2.0f };
     
@@ -142,26 +226,39 @@ void Chain::draw(LGFX_Sprite* sprite, uint16_t fillColor, uint16_t strokeColor)
         Point pControl = outlinePoints[i];
         Point pEnd = { (outlinePoints[i].x + outlinePoints[i+1].x)/2.0f, (outlinePoints[i].y + outlinePoints[i+1].y)/2.0f };
         
-        drawQuadraticBezier(sprite, pStart.x, pStart.y, pControl.x, pControl.y, pEnd.x, pEnd.y, strokeColor);
+        drawQuadraticBezier(sprite, pStart.x, pStart.y, pControl.x, pControl.y, pEnd.x, pEnd.y, strokeColor, maxSegments);
         pStart = pEnd;
     }
     // Close final segment
     Point lastP = outlinePoints[len-1];
     Point firstMid = { (outlinePoints[0].x + outlinePoints[1].x)/2.0f, (outlinePoints[0].y + outlinePoints[1].y)/2.0f };
-    drawQuadraticBezier(sprite, pStart.x, pStart.y, lastP.x, lastP.y, firstMid.x, firstMid.y, strokeColor);
+    drawQuadraticBezier(sprite, pStart.x, pStart.y, lastP.x, lastP.y, firstMid.x, firstMid.y, strokeColor, maxSegments);
 }
 
-void Chain::drawRig(LGFX_Sprite* sprite, uint16_t color) {
-    for (int i = 0; i < length_; ++i) {
+template <int N>
+void Chain<N>::drawRig(LGFX_Sprite* sprite, uint16_t color) {
+    for (int i = 0; i < N; ++i) {
         Point p = circles_[i].getPosition();
         sprite->drawCircle((int)p.x, (int)p.y, (int)circles_[i].getRadius(), color);
-        if(i < length_ - 1) {
+        if(i < N - 1) {
             Point pNext = circles_[i+1].getPosition();
             sprite->drawLine((int)p.x, (int)p.y, (int)pNext.x, (int)pNext.y, color);
         }
     }
 }
 
-Circle& Chain::getCircle(int index) {
-    return circles_[index];
-}
\ No newline at end of file
+template <int N>
+Rect Chain<N>::getDirtyRect() const {
+    Rect r = emptyRect();
+    for (int i = 0; i < N; ++i) {
+        Point p = circles_[i].getPosition();
+        r = unionRect(r, rectAround(p.x, p.y, circles_[i].getRadius()));
+    }
+    return r;
+}
+
+// The shapes a fish is built from, see FishSpecies.h
+template class Chain<FISH_BODY_JOINTS>;
+template class Chain<FISH_BACK_FIN_JOINTS>;
+template class Chain<FISH_FIN_JOINTS>;
+template class Chain<FISH_TAIL_JOINTS>;
@@ -1,35 +1,62 @@
 #pragma once
 #include "../helper.h"
 #include "Circle.h"
-#include <vector>
 
-#define MAX_CHAIN_LENGTH 20
+// How much of a chain draw() renders, most detailed first
+enum ChainDetail : uint8_t {
+    CHAIN_DETAIL_FULL,      // fill and smooth outline
+    CHAIN_DETAIL_COARSE,    // fill and an outline of BEZIER_COARSE_SEGMENTS per curve
+    CHAIN_DETAIL_FILL       // fill only
+};
 
+// A run of N joints inside its fish's block of the skeleton store. The
+// chain keeps only its offset into that block; bind() points it at the
+// joints whenever the block moves, e.g. after a scene snapshot is copied.
+// N is fixed per shape so every joint loop has a compile-time trip count;
+// Chain.cpp instantiates the lengths the fish use.
+template <int N>
 class Chain {
     public:
-        // Adjusted constructor to take a vector or array pointer + length
-        Chain(float x, float y, float gap, float angle, const std::vector<float>& sizes);
-        Chain() = default; // Default constructor for vectors
+        // Lays the joints out at fishJoints + offset, one per entry of sizes
+        Chain(Circle *fishJoints, int offset, float x, float y, float gap, float angle, const float (&sizes)[N]);
+        Chain() = default; // Default constructor for arrays
+
+        void bind(Circle *fishJoints) { circles_ = fishJoints + offset_; }
+        int getOffset() const { return offset_; }
 
         void freeMove(float x, float y, int width, int height);
-        void constrainMove(float x, float y, float idealRadian, float constrainStrength = 0.7f);
+        // idealDirection is a unit vector; the second joint turns that way
+        // by constrainStrength of the angle between them
+        void constrainMove(float x, float y, const Point &idealDirection, float constrainStrength = 0.7f);
         void simpleMove(float x, float y, int width, int height);
 
-        void draw(LGFX_Sprite* sprite, uint16_t fillColor, uint16_t strokeColor);
+        void draw(LGFX_Sprite* sprite, uint16_t fillColor, uint16_t strokeColor, ChainDetail detail = CHAIN_DETAIL_FULL);
         void drawRig(LGFX_Sprite* sprite, uint16_t color);
         
         Point calculatePoint(const Circle& circle, float radian);
-        Circle& getCircle(int index);
-        int getLength() const { return length_; }
+        Circle& getCircle(int index) const { return circles_[index]; }
+        static constexpr int getLength() { return N; }
+        Rect getDirtyRect() const;
 
         // Expose circles for Fish class access
-        Circle circles_[MAX_CHAIN_LENGTH];
+        Circle *circles_ = nullptr;
 
     private:
-        float x_;
-        float y_;
         float gap_;
         float smallestAngle_;
         float frameCount_ = 0;
-        int length_ = 0;
-};
\ No newline at end of file
+        uint8_t offset_ = 0;
+
+        // The joint limit and the oscillation phase step between links, as
+        // rotations, so following needs no angles
+        float cosSmallest_ = 1.0f;
+        float sinSmallest_ = 0.0f;
+        float cosPhaseStep_ = 1.0f;
+        float sinPhaseStep_ = 0.0f;
+
+        // Pulls links First..N-1 in behind their predecessors and bends each
+        // joint no tighter than smallestAngle_. With a non-zero
+        // oscillateScale each link also swings by the freeMove() wave.
+        template <int First>
+        void followLinks(float oscillateScale = 0.0f);
+};
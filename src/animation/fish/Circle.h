@@ -12,18 +12,9 @@ class Circle {
 
         float followPoint(float targetX, float targetY, uint32_t width, uint32_t height);
         
-        void followBody(const Circle &target,
-                        const Circle *targetOfTarget,
-                        float gap, float smallestAngle,
-                        float *oscillateRadian = nullptr);
-        
-        void teleport(float x, float y);
-        void applyPullingForce(const Circle &target, float gap, float *oscillateRadian = nullptr);
-        void applyAngleConstrain(const Point &center,
-                                const Point &theOtherPoint,
-                                float gap, float smallestAngle);
+        void teleport(float x, float y) { x_ = x; y_ = y; }
 
-        Point getPosition() const;
+        Point getPosition() const { return {x_, y_}; }
         float getRadius() const { return radius_; }
 
     private:
@@ -1,31 +1,33 @@
 #include "Cube.h"
 
-Cube::Cube(float x, float y, float vMax) : x_(x), y_(y), vMax(vMax) {
+Cube::Cube(float x, float y, float vMax, uint32_t seed)
+    : vMax(vMax), x_(x), y_(y), random_(seed)
+{
     vMin = vMax * 0.1f;
     vDash = vMax * 2.0f;
-    vX = randomFloat(0.0f, vMax);
-    vY = randomFloat(0.0f, vMax);
+    vX = random_.range(0.0f, vMax);
+    vY = random_.range(0.0f, vMax);
     w_ = 10.0f; // Arbitrary size for bounds
     h_ = 10.0f;
-    directionX = (randomFloat(0.0f, 1.0f) < 0.5f) ? 1 : -1;
-    directionY = (randomFloat(0.0f, 1.0f) < 0.5f) ? 1 : -1;
+    directionX = (random_.nextFloat() < 0.5f) ? 1 : -1;
+    directionY = (random_.nextFloat() < 0.5f) ? 1 : -1;
 }
 
 void Cube::update(int xBound, int yBound) {
-    if (randomFloat(0.0f, 1.0f) < pBoost_ || (vX - vMin) <= 0.002f) {
+    if (random_.nextFloat() < pBoost_ || (vX - vMin) <= 0.002f) {
         vX = boostVelocity();
-        directionX *= (randomFloat(0.0f, 1.0f) < 0.2f) ? -1 : 1;
+        directionX *= (random_.nextFloat() < 0.2f) ? -1 : 1;
     }
-    if (randomFloat(0.0f, 1.0f) < pBoost_ || (vY - vMin) <= 0.002f) {
+    if (random_.nextFloat() < pBoost_ || (vY - vMin) <= 0.002f) {
         vY = boostVelocity();
-        directionY *= (randomFloat(0.0f, 1.0f) < 0.2f) ? -1 : 1;
+        directionY *= (random_.nextFloat() < 0.2f) ? -1 : 1;
     }
 
-    if (vX > vMin) vX -= (vX - vMin) * randomFloat(0.01f, 0.02f);
-    if (vY > vMin) vY -= (vY - vMin) * randomFloat(0.01f, 0.02f);
+    if (vX > vMin) vX -= (vX - vMin) * random_.range(0.01f, 0.02f);
+    if (vY > vMin) vY -= (vY - vMin) * random_.range(0.01f, 0.02f);
 
-    if (randomFloat(0.0f, 1.0f) < pDirectionChange_) directionX *= -1;
-    if (randomFloat(0.0f, 1.0f) < pDirectionChange_) directionY *= -1;
+    if (random_.nextFloat() < pDirectionChange_) directionX *= -1;
+    if (random_.nextFloat() < pDirectionChange_) directionY *= -1;
 
     x_ += vX * directionX;
     y_ += vY * directionY;
@@ -39,7 +41,7 @@ void Cube::move(float dx, float dy) {
 }
 
 float Cube::boostVelocity() {
-    return randomFloat(vMax / 2.0f, vMax);
+    return random_.range(vMax / 2.0f, vMax);
 }
 
 void Cube::preventOverBoarder(int xBound, int yBound) {
@@ -59,8 +61,8 @@ void Cube::preventOverBoarder(int xBound, int yBound) {
 }
 
 void Cube::dash(float radian) {
-    float velX = vDash * cos(radian);
-    float velY = vDash * sin(radian);
+    float velX = vDash * mathCos(radian);
+    float velY = vDash * mathSin(radian);
     vX = abs(velX);
     vY = abs(velY);
     directionX = (velX >= 0) ? 1 : -1;
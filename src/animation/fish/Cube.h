@@ -1,11 +1,12 @@
 #pragma once
 #include <Arduino.h>
 #include "../helper.h"
+#include "../Random.h"
 #include "Chain.h"
 
 class Cube {
     public:
-        Cube(float x, float y, float vMax);
+        Cube(float x, float y, float vMax, uint32_t seed);
         Cube() = default;
 
         void update(int xBound, int yBound);
@@ -22,6 +23,7 @@ class Cube {
         float w_, h_;
         float pBoost_ = 0.005f;
         float pDirectionChange_ = 0.001f;
+        Random random_;
         
         float boostVelocity();
         void preventOverBoarder(int xBound, int yBound);
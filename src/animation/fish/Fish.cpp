@@ -1,54 +1,63 @@
 #include "Fish.h"
 
-Fish::Fish(float x, float y, float length, float width, int canvasWidth, int canvasHeight, uint16_t fillColor, uint16_t strokeColor):
-    fillColor_(fillColor), strokeColor_(strokeColor){
+Fish::Fish(Circle *joints, const FishSpecies &species, float x, float y, float length, float width, int /*canvasWidth*/, int /*canvasHeight*/, Random &random, uint16_t fillColor, uint16_t strokeColor, uint16_t backFinColor):
+    species_(&species), fillColor_(fillColor), strokeColor_(strokeColor), backFinColor_(backFinColor){
     
     // Initialize random swim speed
-    swimSpeed_ = randomFloat(3.0f, 5.0f);
+    swimSpeed_ = random.range(species.minSwimSpeed, species.maxSwimSpeed);
 
-    gap_ = length / (float)bodyPoints.size();
-    float smallestAngle = 165.0f;
+    gap_ = length / (float)FISH_BODY_JOINTS;
+    int offset = 0;
     
-    std::vector<float> sizes;
-    for(float p : bodyPoints) sizes.push_back(p * width);
+    float sizes[FISH_BODY_JOINTS];
+    for (int i = 0; i < FISH_BODY_JOINTS; i++) sizes[i] = species.bodyPoints[i] * width;
     
-    body_ = Chain(x, y, gap_, smallestAngle, sizes);
-    cube_ = Cube(x, y, width * 0.15f);
-
-    // Fins
-    int finPos[] = {2, 2, 6, 6};
-    float finRadianBase = PI / 1.8f;
-    for (int i = 0; i < 4; i++) {
-        int pos = finPos[i];
-        float finFactor = bodyPoints[pos] * 0.8f;
-        std::vector<float> fSizes;
-        for(float p : finPoints) fSizes.push_back(p * width * (i <= 1 ? 1.5f : 1.0f) * finFactor);
-
-        float angle = (i <= 1 ? 175.0f : 155.0f) + 20.0f * (width / length);
-        Chain newFin(x, y, gap_ * 2.5f * (width / length), angle, fSizes);
+    body_ = Chain<FISH_BODY_JOINTS>(joints, offset, x, y, gap_, species.bodyAngle, sizes);
+    offset += body_.getLength();
+    cube_ = Cube(x, y, width * 0.15f, random.fork());
+
+    // Back Fin
+    int backFinPos = species.backFinPosition;
+    float bfSizes[FISH_BACK_FIN_JOINTS] = {0, 0, 0};
+    Chain<FISH_BACK_FIN_JOINTS> newBackFin(joints, offset, x, y, gap_ * 1.5f, species.backFinAngle, bfSizes);
+    offset += newBackFin.getLength();
+    backFin_ = {newBackFin, 0.0f, backFinPos, {1.0f, 0.0f}};
+
+    // Fins, left then right of each pair
+    for (int i = 0; i < FISH_FINS; i++) {
+        int pair = i / 2;
+        int pos = species.finPositions[pair];
+        float finFactor = species.bodyPoints[pos] * 0.8f;
+        float fSizes[FISH_FIN_JOINTS];
+        for (int j = 0; j < FISH_FIN_JOINTS; j++) fSizes[j] = species.finPoints[j] * width * species.finScales[pair] * finFactor;
+
+        float angle = species.finAngles[pair] + 20.0f * (width / length);
+        Chain<FISH_FIN_JOINTS> newFin(joints, offset, x, y, gap_ * 2.5f * (width / length), angle, fSizes);
+        offset += newFin.getLength();
         
-        float radian = finRadianBase * (i % 2 == 0 ? 1 : -1) * finFactor;
-        fins_.push_back({newFin, radian, pos});
+        float radian = species.finSpread * (i % 2 == 0 ? 1 : -1) * finFactor;
+        fins_[i] = {newFin, radian, pos, {mathCos(radian), mathSin(radian)}};
     }
 
     // Tails
-    float tailRadian = PI / 5.0f;
-    int tailPos[] = {12, 12};
-    for (int i = 0; i < 2; i++) {
-        int pos = tailPos[i];
-        std::vector<float> tSizes;
-        for(float p : tailPoints) tSizes.push_back(width * p);
-
-        Chain newTail(x, y, gap_ * 0.5f * randomFloat(0.7f, 0.9f), 120.0f, tSizes);
-        float radian = randomFloat(0.0f, tailRadian) * (i % 2 == 0 ? 1 : -1);
-        tails_.push_back({newTail, radian, pos});
+    for (int i = 0; i < FISH_TAILS; i++) {
+        int pos = species.tailPosition;
+        float tSizes[FISH_TAIL_JOINTS];
+        for (int j = 0; j < FISH_TAIL_JOINTS; j++) tSizes[j] = width * species.tailPoints[j];
+
+        float tailGap = gap_ * 0.5f * random.range(species.minTailGap, species.maxTailGap);
+        Chain<FISH_TAIL_JOINTS> newTail(joints, offset, x, y, tailGap, 120.0f, tSizes);
+        offset += newTail.getLength();
+        float radian = random.range(0.0f, species.tailSpread) * (i % 2 == 0 ? 1 : -1);
+        tails_[i] = {newTail, radian, pos, {mathCos(radian), mathSin(radian)}};
     }
+}
 
-    // Back Fin
-    int backFinPos = 3;
-    std::vector<float> bfSizes = {0,0,0}; 
-    Chain newBackFin(x, y, gap_ * 1.5f, 120.0f, bfSizes);
-    backFins_.push_back({newBackFin, 0.0f, backFinPos});
+void Fish::bind(Circle *joints) {
+    body_.bind(joints);
+    backFin_.fin.bind(joints);
+    for (auto& f : fins_) f.fin.bind(joints);
+    for (auto& t : tails_) t.fin.bind(joints);
 }
 
 void Fish::update(int width, int height) {
@@ -57,32 +66,32 @@ void Fish::update(int width, int height) {
     
     body_.freeMove(pos.x, pos.y, width, height);
 
-    for (auto& bf : backFins_) {
-        Point start = body_.getCircle(bf.position).getPosition();
-        Point next = body_.getCircle(bf.position + 1).getPosition();
-        float radian = findTangent(start, next) + bf.radian;
-        bf.fin.constrainMove(start.x, start.y, radian, 0.0f);
-    }
+    Point backStart = body_.getCircle(backFin_.position).getPosition();
+    backFin_.fin.constrainMove(backStart.x, backStart.y, finHeading(backFin_), 0.0f);
 
-    for (int i = 0; i < fins_.size(); i++) {
+    for (int i = 0; i < FISH_FINS; i++) {
         auto& f = fins_[i];
         Point start = body_.getCircle(f.position).getPosition();
-        Point next = body_.getCircle(f.position + 1).getPosition();
-        float radian = findTangent(start, next) + f.radian;
-        f.fin.constrainMove(start.x, start.y, radian, (i <= 1 ? 0.3f : 0.8f));
+        f.fin.constrainMove(start.x, start.y, finHeading(f), species_->finStrengths[i / 2]);
     }
 
-    for (int i = 0; i < tails_.size(); i++) {
-        auto& t = tails_[i];
+    for (auto& t : tails_) {
         Point start = body_.getCircle(t.position).getPosition();
-        Point next = body_.getCircle(t.position + 1).getPosition();
-        float radian = findTangent(start, next) + t.radian;
-        t.fin.constrainMove(start.x, start.y, radian, 0.3f);
+        t.fin.constrainMove(start.x, start.y, finHeading(t), species_->tailStrength);
     }
 }
 
+template <int N>
+Point Fish::finHeading(const FinConfig<N> &config) {
+    // Body direction at the attachment joint, turned by the fin's angle
+    Point start = body_.getCircle(config.position).getPosition();
+    Point next = body_.getCircle(config.position + 1).getPosition();
+    Point d = normalizeVector({next.x - start.x, next.y - start.y}, 1.0f);
+    return { d.x * config.turn.x - d.y * config.turn.y, d.x * config.turn.y + d.y * config.turn.x };
+}
+
 void Fish::triggerDash() {
-    float angle = atan2(cube_.vY * cube_.directionY, cube_.vX * cube_.directionX);
+    float angle = mathAtan2(cube_.vY * cube_.directionY, cube_.vX * cube_.directionX);
     cube_.dash(angle);
 }
 
@@ -99,7 +108,7 @@ Point Fish::getPosition() const {
 }
 
 float Fish::getVelocity() const {
-    return sqrt(pow(cube_.vX, 2) + pow(cube_.vY, 2));
+    return mathSqrt(cube_.vX * cube_.vX + cube_.vY * cube_.vY);
 }
 
 float Fish::getWidth() const {
@@ -128,34 +137,63 @@ FishBounds Fish::getBounds() const {
     return {minX - gap_, maxX + gap_, minY - gap_, maxY + gap_};
 }
 
+Rect Fish::getDirtyRect() const {
+    Rect r = body_.getDirtyRect();
+    r = unionRect(r, backFin_.fin.getDirtyRect());
+    for (const auto& f : fins_) r = unionRect(r, f.fin.getDirtyRect());
+    for (const auto& t : tails_) r = unionRect(r, t.fin.getDirtyRect());
+
+    // Eyes sit on the body_[2] radius around the head, see drawEyes()
+    Point p0 = body_.circles_[0].getPosition();
+    float eyeReach = body_.circles_[2].getRadius() + gap_ * 0.4f;
+    return unionRect(r, rectAround(p0.x, p0.y, eyeReach));
+}
+
+bool Fish::trackDirty(Rect &previous, Rect &current) {
+    // The cube never stops, so a fish is redrawn every frame
+    previous = drawnRect_;
+    current = getDirtyRect();
+    drawnRect_ = current;
+    return true;
+}
+
 void Fish::draw(LGFX_Sprite* sprite) {
-    for (auto& f : fins_) f.fin.draw(sprite, fillColor_, strokeColor_);
-    for (int i = 0; i < tails_.size(); i++) {
+    ChainDetail chainDetail = detail_ == FISH_DETAIL_FULL ? CHAIN_DETAIL_FULL
+                            : detail_ == FISH_DETAIL_COARSE ? CHAIN_DETAIL_COARSE
+                            : CHAIN_DETAIL_FILL;
+    // Merged: the larger front fins stand in for the rear pair and one tail
+    // for both; the fills overlap anyway once the outlines are gone
+    bool merged = detail_ == FISH_DETAIL_MERGED;
+    int finCount = merged ? 2 : FISH_FINS;
+    int tailCount = merged ? 1 : FISH_TAILS;
+
+    for (int i = 0; i < finCount; i++) fins_[i].fin.draw(sprite, fillColor_, strokeColor_, chainDetail);
+    for (int i = 0; i < tailCount; i++) {
         auto& t = tails_[i];
-        t.fin.draw(sprite, fillColor_, strokeColor_);
+        t.fin.draw(sprite, fillColor_, strokeColor_, chainDetail);
     }
-    body_.draw(sprite, fillColor_, strokeColor_);
-    drawBackFin(sprite);
+    body_.draw(sprite, fillColor_, strokeColor_, chainDetail);
+    if (chainDetail != CHAIN_DETAIL_FILL) drawBackFin(sprite);
     drawEyes(sprite);
 }
 
 void Fish::drawBackFin(LGFX_Sprite* ctx) {
-    for (auto& bf : backFins_) {
-        int endPosition = bf.position + backFinPoints.size() + 1;
-        if(endPosition >= body_.getLength()) continue;
-
-        Point finPoint = bf.fin.getCircle(backFinPoints.size() - 1).getPosition();
-        Point startPoint = body_.getCircle(bf.position + 1).getPosition();
-        Point endPoint = body_.getCircle(endPosition).getPosition();
-
-        drawQuadraticBezier(ctx, startPoint.x, startPoint.y, finPoint.x, finPoint.y, endPoint.x, endPoint.y, TFT_DARKGREY);
-
-        for (int i = endPosition; i >= bf.position + 2; i--) {
-            Point pCurr = body_.getCircle(i).getPosition();
-            Point pPrev = body_.getCircle(i-1).getPosition();
-            Point mid = {(pCurr.x + pPrev.x)/2.0f, (pCurr.y + pPrev.y)/2.0f};
-            ctx->drawLine((int)pCurr.x, (int)pCurr.y, (int)mid.x, (int)mid.y, strokeColor_);
-        }
+    const auto &bf = backFin_;
+    int endPosition = bf.position + FISH_BACK_FIN_JOINTS + 1;
+    if(endPosition >= body_.getLength()) return;
+
+    Point finPoint = bf.fin.getCircle(FISH_BACK_FIN_JOINTS - 1).getPosition();
+    Point startPoint = body_.getCircle(bf.position + 1).getPosition();
+    Point endPoint = body_.getCircle(endPosition).getPosition();
+
+    int maxSegments = detail_ == FISH_DETAIL_COARSE ? BEZIER_COARSE_SEGMENTS : BEZIER_MAX_SEGMENTS;
+    drawQuadraticBezier(ctx, startPoint.x, startPoint.y, finPoint.x, finPoint.y, endPoint.x, endPoint.y, backFinColor_, maxSegments);
+
+    for (int i = endPosition; i >= bf.position + 2; i--) {
+        Point pCurr = body_.getCircle(i).getPosition();
+        Point pPrev = body_.getCircle(i-1).getPosition();
+        Point mid = {(pCurr.x + pPrev.x)/2.0f, (pCurr.y + pPrev.y)/2.0f};
+        ctx->drawLine((int)pCurr.x, (int)pCurr.y, (int)mid.x, (int)mid.y, strokeColor_);
     }
 }
 
@@ -167,8 +205,8 @@ void Fish::drawEyes(LGFX_Sprite* ctx) {
     float eyeSize = gap_ * 0.4f;
 
     auto drawEye = [&](float rad) {
-        float dx = eyeDist * cos(rad);
-        float dy = eyeDist * sin(rad);
+        float dx = eyeDist * mathCos(rad);
+        float dy = eyeDist * mathSin(rad);
         ctx->fillCircle((int)(p0.x + dx), (int)(p0.y + dy), (int)eyeSize, strokeColor_);
     };
     drawEye(radian + PI / 4.0f);
@@ -1,25 +1,53 @@
 #pragma once
 #include "Chain.h"
 #include "Cube.h"
-#include <vector>
+#include "FishSpecies.h"
 #include <LovyanGFX.hpp>
 
+template <int N>
 struct FinConfig {
-    Chain fin;
+    Chain<N> fin;
     float radian;
     int position;
+    // (cos, sin) of radian, to turn the body heading without angles
+    Point turn;
 };
 
 struct FishBounds {
     float left, right, top, bottom;
 };
 
+// Rendering tiers, cheapest last. The shape and dirty rect are the same at
+// every tier; only how much of it is drawn changes.
+enum FishDetail : uint8_t {
+    FISH_DETAIL_FULL,       // smooth outlines, back fin, all fins
+    FISH_DETAIL_COARSE,     // outlines with BEZIER_COARSE_SEGMENTS per curve
+    FISH_DETAIL_FILL,       // fills and eyes, no outlines or back fin
+    FISH_DETAIL_MERGED,     // fills, one fin per side and a single tail
+    FISH_DETAIL_TIERS
+};
+
 class Fish {
     public:
-        Fish(float x, float y, float length, float width, int canvasWidth, int canvasHeight, uint16_t fillColor = TFT_BLACK, uint16_t strokeColor = TFT_WHITE);
+        // Anatomy comes from species; the variation within it is drawn from
+        // random, which also seeds the fish's own movement generator. joints
+        // must hold jointCount() entries; the FishSchool hands each fish its
+        // block. Allocates nothing.
+        Fish(Circle *joints, const FishSpecies &species, float x, float y, float length, float width, int canvasWidth, int canvasHeight, Random &random, uint16_t fillColor = TFT_BLACK, uint16_t strokeColor = TFT_WHITE, uint16_t backFinColor = TFT_DARKGREY);
+
+        // Joints across every chain of one fish
+        static constexpr int jointCount() {
+            return FISH_BODY_JOINTS + FISH_BACK_FIN_JOINTS
+                 + FISH_FINS * FISH_FIN_JOINTS + FISH_TAILS * FISH_TAIL_JOINTS;
+        }
+        // Re-points the chains after the joint block moved
+        void bind(Circle *joints);
         
         void update(int width, int height);
         void draw(LGFX_Sprite* sprite);
+        // Tier used by draw(); picked each frame by the FishDetailBudget
+        void setDetail(FishDetail detail) { detail_ = detail; }
+        FishDetail getDetail() const { return detail_; }
         
         void triggerDash();               
         void triggerDash(float radian);   
@@ -30,33 +58,37 @@ class Fish {
         float getVelocity() const;
         float getWidth() const;
         float getSwimSpeed() const { return swimSpeed_; } // Getter
+        const FishSpecies &getSpecies() const { return *species_; }
         
         bool getIsDashing() const;
         FishBounds getBounds() const;
+        // Screen area touched by draw(), including fins, tails and eyes.
+        Rect getDirtyRect() const;
+        // Reports the rect drawn last frame and the one about to be drawn.
+        // Returns true when the pixels inside may differ between the two.
+        bool trackDirty(Rect &previous, Rect &current);
 
     private:
+        const FishSpecies *species_;
         float gap_;
-        Chain body_;
+        Chain<FISH_BODY_JOINTS> body_;
         Cube cube_;
         uint16_t fillColor_ = TFT_BLACK;
         uint16_t strokeColor_ = TFT_WHITE;
+        uint16_t backFinColor_ = TFT_DARKGREY;
         float swimSpeed_;
+        Rect drawnRect_ = {0, 0, 0, 0};
+        FishDetail detail_ = FISH_DETAIL_FULL;
         
-        std::vector<FinConfig> fins_;
-        std::vector<FinConfig> tails_;
-        std::vector<FinConfig> backFins_;
+        // Chains are laid out in the joint block in update order: body, back
+        // fin, fins, tails
+        FinConfig<FISH_BACK_FIN_JOINTS> backFin_;
+        FinConfig<FISH_FIN_JOINTS> fins_[FISH_FINS];
+        FinConfig<FISH_TAIL_JOINTS> tails_[FISH_TAILS];
 
+        // Unit vector a fin's root link aims along
+        template <int N>
+        Point finHeading(const FinConfig<N> &config);
         void drawBackFin(LGFX_Sprite* ctx);
         void drawEyes(LGFX_Sprite* ctx);
-
-        const std::vector<float> bodyPoints = {
-            0.326, 0.641, 0.817, 0.9, 0.97, 0.957, 0.872, 0.787, 0.702, 0.618, 0.516, 0.414, 0.316, 0.219
-        };
-        const std::vector<float> finPoints = {
-            0.226, 0.217, 0.334, 0.476, 0.424, 0.355, 0.11
-        };
-        const std::vector<float> tailPoints = {
-            0.326, 0.321, 0.32, 0.294, 0.283, 0.216, 0.155, 0.09
-        };
-        const std::vector<float> backFinPoints = {0.5, 0.5, 0.5};
 };
\ No newline at end of file
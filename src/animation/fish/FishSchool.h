@@ -0,0 +1,69 @@
+#pragma once
+#include <utility>
+#include <vector>
+
+#include "Fish.h"
+
+// Every fish in the pond plus one skeleton store holding all of their
+// joints back to back, each fish's block sized exactly for its chains.
+// Behaves like a std::vector<Fish>; copying it copies the store and points
+// the copies' chains at their own joints.
+class FishSchool {
+    public:
+        FishSchool() = default;
+        FishSchool(const FishSchool &other) { *this = other; }
+        FishSchool &operator=(const FishSchool &other) {
+            if (this == &other) return *this;
+            joints_ = other.joints_;
+            fishes_ = other.fishes_;
+            bind();
+            return *this;
+        }
+
+        // Sizes both arrays for count fish, so adding them never reallocates
+        void reserve(int count) {
+            fishes_.reserve(count);
+            joints_.reserve(count * Fish::jointCount());
+        }
+        void clear() {
+            fishes_.clear();
+            joints_.clear();
+        }
+
+        // Takes Fish's constructor arguments minus the joint block
+        template <typename... Args>
+        Fish &emplace_back(Args &&... args) {
+            size_t offset = joints_.size();
+            const Circle *before = joints_.data();
+            joints_.resize(offset + Fish::jointCount());
+            fishes_.emplace_back(&joints_[offset], std::forward<Args>(args)...);
+            if (joints_.data() != before) bind();
+            return fishes_.back();
+        }
+
+        size_t size() const { return fishes_.size(); }
+        bool empty() const { return fishes_.empty(); }
+        Fish &operator[](size_t i) { return fishes_[i]; }
+        const Fish &operator[](size_t i) const { return fishes_[i]; }
+        std::vector<Fish>::iterator begin() { return fishes_.begin(); }
+        std::vector<Fish>::iterator end() { return fishes_.end(); }
+        std::vector<Fish>::const_iterator begin() const { return fishes_.begin(); }
+        std::vector<Fish>::const_iterator end() const { return fishes_.end(); }
+
+        // The whole store, for the bench and capacity checks
+        int jointCount() const { return (int)joints_.size(); }
+        size_t bytes() const { return fishes_.size() * sizeof(Fish) + joints_.size() * sizeof(Circle); }
+
+    private:
+        std::vector<Circle> joints_;
+        std::vector<Fish> fishes_;
+
+        // Points every fish at its block of joints_
+        void bind() {
+            Circle *joints = joints_.data();
+            for (auto& fish : fishes_) {
+                fish.bind(joints);
+                joints += Fish::jointCount();
+            }
+        }
+};
@@ -0,0 +1,57 @@
+#include "FishSpecies.h"
+#include "../helper.h"
+
+constexpr FishSpecies KOI_SPECIES = {
+    "koi",
+    {0.326, 0.641, 0.817, 0.9, 0.97, 0.957, 0.872, 0.787, 0.702, 0.618, 0.516, 0.414, 0.316, 0.219},
+    {0.226, 0.217, 0.334, 0.476, 0.424, 0.355, 0.11},
+    {0.326, 0.321, 0.32, 0.294, 0.283, 0.216, 0.155, 0.09},
+    6.0f, 8.5f,
+    0.24f, 0.28f,
+    3.0f, 5.0f,
+    165.0f,
+
+    3, 120.0f,
+
+    {2, 6},
+    {1.5f, 1.0f},
+    {175.0f, 155.0f},
+    {0.3f, 0.8f},
+    PI / 1.8f,
+
+    12, PI / 5.0f,
+    0.7f, 0.9f,
+    0.3f,
+
+    0x1D1D1D,
+    0x9B9B9B
+};
+
+constexpr FishSpecies COMET_SPECIES = {
+    "comet",
+    {0.3, 0.6, 0.78, 0.86, 0.9, 0.88, 0.8, 0.7, 0.6, 0.5, 0.4, 0.3, 0.22, 0.15},
+    {0.2, 0.2, 0.3, 0.4, 0.36, 0.3, 0.1},
+    {0.3, 0.34, 0.36, 0.36, 0.34, 0.3, 0.24, 0.15},
+    6.5f, 9.0f,
+    0.18f, 0.22f,
+    4.0f, 6.0f,
+    160.0f,
+
+    4, 120.0f,
+
+    {2, 5},
+    {1.2f, 0.8f},
+    {175.0f, 160.0f},
+    {0.4f, 0.8f},
+    PI / 2.2f,
+
+    12, PI / 4.0f,
+    1.0f, 1.3f,
+    0.2f,
+
+    0xB4502D,
+    0xE6C8AA
+};
+
+const FishSpecies *const FISH_SPECIES[] = { &KOI_SPECIES, &COMET_SPECIES };
+const int FISH_SPECIES_COUNT = sizeof(FISH_SPECIES) / sizeof(FISH_SPECIES[0]);
@@ -0,0 +1,64 @@
+#pragma once
+#include <stdint.h>
+
+// Joints per chain. Every species shares them, so every fish has the same
+// skeleton layout and the chains stay compile-time sized.
+#define FISH_BODY_JOINTS 14
+#define FISH_BACK_FIN_JOINTS 3
+#define FISH_FIN_JOINTS 7
+#define FISH_TAIL_JOINTS 8
+
+#define FISH_FINS 4
+#define FISH_TAILS 2
+
+// Everything that makes one kind of fish look and swim differently. The
+// descriptors are constant tables in flash; a fish only keeps a pointer to
+// its own, so any mix of species costs nothing per instance.
+struct FishSpecies {
+    const char *name;
+
+    // Joint diameters as fractions of the fish's width
+    float bodyPoints[FISH_BODY_JOINTS];
+    float finPoints[FISH_FIN_JOINTS];
+    float tailPoints[FISH_TAIL_JOINTS];
+
+    // Size, as multiples of the pond's base fish size, and body proportion
+    float minLength, maxLength;
+    float minWidthRatio, maxWidthRatio;
+    float minSwimSpeed, maxSwimSpeed;
+    // Tightest bend between body links, in degrees
+    float bodyAngle;
+
+    // Body joint the back fin rises from, and its tightest bend
+    uint8_t backFinPosition;
+    float backFinAngle;
+
+    // Fins come in left/right pairs, front pair first. Each pair hangs off
+    // one body joint, splays by up to finSpread radians and is scaled,
+    // bent and stiffened per pair.
+    uint8_t finPositions[FISH_FINS / 2];
+    float finScales[FISH_FINS / 2];
+    float finAngles[FISH_FINS / 2];
+    float finStrengths[FISH_FINS / 2];
+    float finSpread;
+
+    // Tails share one body joint and splay by up to tailSpread radians;
+    // their link gap is half the body gap times a random factor in this range
+    uint8_t tailPosition;
+    float tailSpread;
+    float minTailGap, maxTailGap;
+    float tailStrength;
+
+    // 0xRRGGBB
+    uint32_t fillColor;
+    uint32_t strokeColor;
+};
+
+// The dark koi the pond has always had
+extern const FishSpecies KOI_SPECIES;
+// Slimmer and paler, with long trailing tails and small fins
+extern const FishSpecies COMET_SPECIES;
+
+// Every species, for picking a mix by count
+extern const FishSpecies *const FISH_SPECIES[];
+extern const int FISH_SPECIES_COUNT;
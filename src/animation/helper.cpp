@@ -7,22 +7,23 @@ float findAngleBetween(const Point &pointCenter, const Point &pointA, const Poin
     float vectorBy = pointB.y - pointCenter.y;
 
     float vectorDotProduct = vectorAx * vectorBx + vectorAy * vectorBy;
-    float vectorLengthProduct = sqrt(pow(vectorAx, 2) + pow(vectorAy, 2)) * sqrt(pow(vectorBx, 2) + pow(vectorBy, 2));
+    // One reciprocal square root of the product instead of two square roots
+    float lengthProductSq = (vectorAx * vectorAx + vectorAy * vectorAy) * (vectorBx * vectorBx + vectorBy * vectorBy);
     
-    if (vectorLengthProduct == 0) {
+    if (lengthProductSq == 0) {
         return 0.0f;
     } else {
         // --- FIX: Clamp the value to the valid range for acos [-1, 1] ---
-        float value = vectorDotProduct / vectorLengthProduct;
+        float value = vectorDotProduct * mathInvSqrt(lengthProductSq);
         if (value > 1.0f) value = 1.0f;
         if (value < -1.0f) value = -1.0f;
         
-        return acos(value);
+        return mathAcos(value);
     }
 }
 
 float findTangent(const Point &pointA, const Point &pointB) {
-    return atan2(pointB.y - pointA.y, pointB.x - pointA.x);
+    return mathAtan2(pointB.y - pointA.y, pointB.x - pointA.x);
 }
 
 bool isOnLeft(const Point &pointA, const Point &pointB, const Point &pointC) {
@@ -30,12 +31,7 @@ bool isOnLeft(const Point &pointA, const Point &pointB, const Point &pointC) {
 }
 
 Point findPosition(const Point &point, float radian, float length){
-    return { point.x + length * cos(radian), point.y + length * sin(radian) };
-}
-
-Point normalizeVector(const Point &vector, float magnitude) {
-    float radian = atan2(vector.y, vector.x);
-    return { magnitude * cos(radian), magnitude * sin(radian) };
+    return { point.x + length * mathCos(radian), point.y + length * mathSin(radian) };
 }
 
 float lerp(float start, float end, float t) {
@@ -47,28 +43,137 @@ float map(float value, float inMin, float inMax, float outMin, float outMax) {
 }
 
 float dist(float x1, float y1, float x2, float y2) {
-    return sqrt(pow(x2 - x1, 2) + pow(y2 - y1, 2));
+    return mathSqrt(distSq(x1, y1, x2, y2));
 }
 
-void drawQuadraticBezier(LGFX_Sprite* sprite, float x0, float y0, float x1, float y1, float x2, float y2, uint16_t color) {
-    float oldX = x0;
-    float oldY = y0;
-    // Lower step = smoother but slower. 0.1 is a good balance.
-    for (float t = 0.1f; t <= 1.0f; t += 0.1f) {
+float distSq(float x1, float y1, float x2, float y2) {
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+    return dx * dx + dy * dy;
+}
+
+Rect emptyRect() {
+    return {0, 0, 0, 0};
+}
+
+Rect rectAround(float x, float y, float radius) {
+    // Primitives truncate their float coordinates, so pad by a pixel each side.
+    return {
+        (int)floorf(x - radius) - 1,
+        (int)floorf(y - radius) - 1,
+        (int)ceilf(x + radius) + 2,
+        (int)ceilf(y + radius) + 2
+    };
+}
+
+Rect unionRect(const Rect &a, const Rect &b) {
+    if (a.isEmpty()) return b;
+    if (b.isEmpty()) return a;
+    return {
+        a.left < b.left ? a.left : b.left,
+        a.top < b.top ? a.top : b.top,
+        a.right > b.right ? a.right : b.right,
+        a.bottom > b.bottom ? a.bottom : b.bottom
+    };
+}
+
+Rect intersectRect(const Rect &a, const Rect &b) {
+    Rect r = {
+        a.left > b.left ? a.left : b.left,
+        a.top > b.top ? a.top : b.top,
+        a.right < b.right ? a.right : b.right,
+        a.bottom < b.bottom ? a.bottom : b.bottom
+    };
+    return r.isEmpty() ? emptyRect() : r;
+}
+
+bool intersects(const Rect &a, const Rect &b) {
+    return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+}
+
+uint16_t scaleColor565(uint16_t color, int num, int den) {
+    int r = ((color >> 11) & 0x1F) * num / den;
+    int g = ((color >> 5) & 0x3F) * num / den;
+    int b = (color & 0x1F) * num / den;
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+// Picks the number of line segments for a quadratic. The chord error of a
+// quadratic split into n equal steps is |p0 - 2p1 + p2| / (4n^2); the control
+// polygon bounds its length. Outlines of short, tight curves keep the full
+// count: once truncated to whole pixels, fewer chords cut corners there.
+static int bezierSegments(float x0, float y0, float x1, float y1, float x2, float y2, int maxSegments, bool outline) {
+    float dx = x0 - 2 * x1 + x2;
+    float dy = y0 - 2 * y1 + y2;
+    float bend = mathSqrt(dx * dx + dy * dy);
+    int n = (int)ceilf(mathSqrt(bend / (4 * BEZIER_TOLERANCE)));
+
+    float length = mathSqrt((x1 - x0) * (x1 - x0) + (y1 - y0) * (y1 - y0))
+                 + mathSqrt((x2 - x1) * (x2 - x1) + (y2 - y1) * (y2 - y1));
+    int byLength = (int)ceilf(length / BEZIER_SEGMENT_LENGTH);
+    if (byLength > BEZIER_LENGTH_SEGMENTS) byLength = BEZIER_LENGTH_SEGMENTS;
+    if (byLength > n) n = byLength;
+    if (outline && length < BEZIER_SHORT_LENGTH && bend > BEZIER_TIGHT_BEND * length) n = BEZIER_MAX_SEGMENTS;
+
+    if (n < 1) return 1;
+    return n > maxSegments ? maxSegments : n;
+}
+
+// True when all control points truncate to the same pixel
+static bool isSinglePixel(float x0, float y0, float x1, float y1, float x2, float y2) {
+    int px = (int)x0;
+    int py = (int)y0;
+    return (int)x1 == px && (int)x2 == px && (int)y1 == py && (int)y2 == py;
+}
+
+// True when the control points' bounding box, which holds the whole curve,
+// misses the sprite's clip rect
+static bool isClippedAway(LGFX_Sprite* sprite, float x0, float y0, float x1, float y1, float x2, float y2) {
+    int32_t cx, cy, cw, ch;
+    sprite->getClipRect(&cx, &cy, &cw, &ch);
+    if ((int)fmaxf(x0, fmaxf(x1, x2)) < cx || (int)fminf(x0, fminf(x1, x2)) > cx + cw - 1) return true;
+    return (int)fmaxf(y0, fmaxf(y1, y2)) < cy || (int)fminf(y0, fminf(y1, y2)) > cy + ch - 1;
+}
+
+void drawQuadraticBezier(LGFX_Sprite* sprite, float x0, float y0, float x1, float y1, float x2, float y2, uint16_t color, int maxSegments) {
+    // Band and dirty-rect passes draw the same outline under many clips
+    if (isClippedAway(sprite, x0, y0, x1, y1, x2, y2)) return;
+    if (isSinglePixel(x0, y0, x1, y1, x2, y2)) {
+        sprite->drawPixel((int)x0, (int)y0, color);
+        return;
+    }
+
+    // Chords that start and end in the same pixel add nothing, so the line
+    // is only drawn as the curve moves to another pixel
+    int segments = bezierSegments(x0, y0, x1, y1, x2, y2, maxSegments, true);
+    int oldX = (int)x0;
+    int oldY = (int)y0;
+    bool drawn = false;
+    for (int i = 1; i <= segments; i++) {
+        float t = (float)i / segments;
         float invT = 1.0f - t;
-        float x = invT * invT * x0 + 2 * invT * t * x1 + t * t * x2;
-        float y = invT * invT * y0 + 2 * invT * t * y1 + t * t * y2;
-        sprite->drawLine((int)oldX, (int)oldY, (int)x, (int)y, color);
+        int x = (int)(invT * invT * x0 + 2 * invT * t * x1 + t * t * x2);
+        int y = (int)(invT * invT * y0 + 2 * invT * t * y1 + t * t * y2);
+        if (x == oldX && y == oldY) continue;
+        sprite->drawLine(oldX, oldY, x, y, color);
         oldX = x;
         oldY = y;
+        drawn = true;
     }
+    if (!drawn) sprite->drawPixel(oldX, oldY, color);
 }
 
 void fillQuadraticBezier(LGFX_Sprite* sprite, Point anchor, float x0, float y0, float x1, float y1, float x2, float y2, uint16_t color) {
+    if (isSinglePixel(anchor.x, anchor.y, x0, y0, x2, y2) && isSinglePixel(x0, y0, x1, y1, x2, y2)) {
+        sprite->drawPixel((int)x0, (int)y0, color);
+        return;
+    }
+
+    int segments = bezierSegments(x0, y0, x1, y1, x2, y2, BEZIER_MAX_SEGMENTS, false);
     float oldX = x0;
     float oldY = y0;
-    // Step 0.1 gives 10 triangles per curve. Decrease for higher quality.
-    for (float t = 0.1f; t <= 1.0f; t += 0.1f) {
+    for (int i = 1; i <= segments; i++) {
+        float t = (float)i / segments;
         float invT = 1.0f - t;
         float x = invT * invT * x0 + 2 * invT * t * x1 + t * t * x2;
         float y = invT * invT * y0 + 2 * invT * t * y1 + t * t * y2;
@@ -79,8 +184,4 @@ void fillQuadraticBezier(LGFX_Sprite* sprite, Point anchor, float x0, float y0,
         oldX = x;
         oldY = y;
     }
-}
-
-float randomFloat(float minValue, float maxValue) {
-    return minValue + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (maxValue - minValue)));
 }
\ No newline at end of file
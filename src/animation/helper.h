@@ -1,6 +1,7 @@
 #pragma once
 #include <cmath>
 #include <LovyanGFX.hpp>
+#include "FastMath.h"
 
 // Constants
 #ifndef PI
@@ -12,19 +13,60 @@ struct Point {
     float y;
 };
 
+// Integer screen rectangle; right and bottom are exclusive.
+struct Rect {
+    int left;
+    int top;
+    int right;
+    int bottom;
+
+    bool isEmpty() const { return right <= left || bottom <= top; }
+    int area() const { return isEmpty() ? 0 : (right - left) * (bottom - top); }
+};
+
 // Math Helpers
 float findAngleBetween(const Point &pointCenter, const Point &pointA, const Point &pointB);
 float findTangent(const Point &pointA, const Point &pointB);
 bool isOnLeft(const Point &pointA, const Point &pointB, const Point &pointC);
 Point findPosition(const Point &point, float radian, float length);
-Point normalizeVector(const Point &vector, float magnitude);
+// Inline so the chain solvers' joint loops need no calls
+inline Point normalizeVector(const Point &vector, float magnitude) {
+    float lengthSq = vector.x * vector.x + vector.y * vector.y;
+    // A zero vector keeps the old atan2(0, 0) = 0 direction
+    if (lengthSq == 0) return { magnitude, 0 };
+    float scale = magnitude * mathInvSqrt(lengthSq);
+    return { vector.x * scale, vector.y * scale };
+}
 
 float lerp(float start, float end, float t);
 float map(float value, float inMin, float inMax, float outMin, float outMax);
 float dist(float x1, float y1, float x2, float y2);
+// Prefer over dist() when only comparing against a radius
+float distSq(float x1, float y1, float x2, float y2);
 
-// Drawing Helpers
-void drawQuadraticBezier(LGFX_Sprite* sprite, float x0, float y0, float x1, float y1, float x2, float y2, uint16_t color);
-void fillQuadraticBezier(LGFX_Sprite* sprite, Point anchor, float x0, float y0, float x1, float y1, float x2, float y2, uint16_t color);
+// Rect Helpers
+Rect emptyRect();
+Rect rectAround(float x, float y, float radius);
+Rect unionRect(const Rect &a, const Rect &b);
+Rect intersectRect(const Rect &a, const Rect &b);
+bool intersects(const Rect &a, const Rect &b);
+
+// Scales each channel of an RGB565 colour by num / den
+uint16_t scaleColor565(uint16_t color, int num, int den);
 
-float randomFloat(float minValue, float maxValue);
\ No newline at end of file
+// Drawing Helpers
+// Curves are split so each chord stays within BEZIER_TOLERANCE pixels of the
+// curve and spans at most BEZIER_SEGMENT_LENGTH pixels, though length alone
+// never asks for more than BEZIER_LENGTH_SEGMENTS
+#define BEZIER_TOLERANCE 0.25f
+#define BEZIER_SEGMENT_LENGTH 1.5f
+#define BEZIER_LENGTH_SEGMENTS 6
+#define BEZIER_MAX_SEGMENTS 10
+// Outlines of curves shorter than this, bending by more than
+// BEZIER_TIGHT_BEND of their length, keep BEZIER_MAX_SEGMENTS
+#define BEZIER_SHORT_LENGTH 12.0f
+#define BEZIER_TIGHT_BEND 0.3f
+// Cap for outlines drawn at reduced detail
+#define BEZIER_COARSE_SEGMENTS 2
+void drawQuadraticBezier(LGFX_Sprite* sprite, float x0, float y0, float x1, float y1, float x2, float y2, uint16_t color, int maxSegments = BEZIER_MAX_SEGMENTS);
+void fillQuadraticBezier(LGFX_Sprite* sprite, Point anchor, float x0, float y0, float x1, float y1, float x2, float y2, uint16_t color);
\ No newline at end of file
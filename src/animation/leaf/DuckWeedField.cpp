@@ -0,0 +1,255 @@
+#include "DuckWeedField.h"
+
+// The batch loops below are written for the auto-vectorizer, which -O2 and
+// -Os builds otherwise only run with its cheapest cost model
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize ("tree-vectorize", "vect-cost-model=dynamic")
+#endif
+
+void DuckWeedField::begin(float minRadius, float maxRadius, uint16_t fillColor, uint16_t strokeColor, uint32_t seed, Palette &palette) {
+    random_.reseed(seed);
+    minRadius_ = minRadius;
+    radiusBuckets_ = (int)ceilf((maxRadius - minRadius) / DUCKWEED_RADIUS_STEP) + 1;
+    if (radiusBuckets_ * DUCKWEED_SHAPE_VARIANTS > 256) radiusBuckets_ = 256 / DUCKWEED_SHAPE_VARIANTS;
+    maxRadius_ = maxRadius;
+    for (int level = 0; level <= DUCKWEED_FADE_STEPS; level++) {
+        fadeFill_[level] = palette.ink(scaleColor565(fillColor, level, DUCKWEED_FADE_STEPS));
+        fadeStroke_[level] = palette.ink(scaleColor565(strokeColor, level, DUCKWEED_FADE_STEPS));
+    }
+
+    auto stamps = std::make_shared<std::vector<Stamp>>();
+    stamps->reserve(radiusBuckets_ * DUCKWEED_SHAPE_VARIANTS);
+    for (int b = 0; b < radiusBuckets_; b++) {
+        float radius = minRadius + b * DUCKWEED_RADIUS_STEP;
+        for (int v = 0; v < DUCKWEED_SHAPE_VARIANTS; v++) {
+            float firstPointRadian = random_.range(0, 2 * PI);
+            float segmentRadian = (2 * PI) / DUCKWEED_SEGMENTS;
+
+            Point outline[DUCKWEED_SEGMENTS];
+            for (int i = 0; i < DUCKWEED_SEGMENTS; i++) {
+                float len = random_.range(radius * 0.98f, radius * 1.02f);
+                outline[i] = findPosition({0, 0}, firstPointRadian + segmentRadian * i, len);
+            }
+            stamps->push_back(Stamp::rasterize(outline, DUCKWEED_SEGMENTS));
+        }
+    }
+    stamps_ = stamps;
+}
+
+void DuckWeedField::clear() {
+    fading_ = 0;
+    retiring_ = 0;
+    pos_.clear();
+    tar_.clear();
+    move_.clear();
+    radius_.clear();
+    vectorMax_.clear();
+    shape_.clear();
+    xDrawn_.clear(); yDrawn_.clear();
+    drawn_.clear();
+    fadeDrawn_.clear();
+    fade_.clear();
+    fadeDir_.clear();
+    escaped_.clear();
+}
+
+void DuckWeedField::reserve(int count) {
+    pos_.reserve(count);
+    tar_.reserve(count);
+    move_.reserve(count);
+    radius_.reserve(count);
+    vectorMax_.reserve(count);
+    shape_.reserve(count);
+    xDrawn_.reserve(count); yDrawn_.reserve(count);
+    drawn_.reserve(count);
+    fadeDrawn_.reserve(count);
+    fade_.reserve(count);
+    fadeDir_.reserve(count);
+    escaped_.reserve(count);
+}
+
+void DuckWeedField::add(float x, float y, float radius) {
+    int bucket = (int)floorf((radius - minRadius_) / DUCKWEED_RADIUS_STEP + 0.5f);
+    if (bucket < 0) bucket = 0;
+    if (bucket >= radiusBuckets_) bucket = radiusBuckets_ - 1;
+    int variant = random_.below(DUCKWEED_SHAPE_VARIANTS);
+
+    pos_.push_back({x, y});
+    tar_.push_back({x, y});
+    move_.push_back({0, 0});
+    radius_.push_back(radius);
+    vectorMax_.push_back(radius * 0.1f);
+    shape_.push_back((uint8_t)(bucket * DUCKWEED_SHAPE_VARIANTS + variant));
+    xDrawn_.push_back(0); yDrawn_.push_back(0);
+    drawn_.push_back(0);
+    fadeDrawn_.push_back(0);
+    fade_.push_back(DUCKWEED_FADE_STEPS);
+    fadeDir_.push_back(0);
+    escaped_.push_back(0);
+}
+
+void DuckWeedField::spawn(int width, int height) {
+    float radius = random_.range(minRadius_, maxRadius_);
+    float x = random_.range(0, width);
+    float y = random_.range(0, height);
+    add(x, y, radius);
+    fade_.back() = 0;
+    fadeDir_.back() = 1;
+    fading_++;
+}
+
+int DuckWeedField::retire(int count) {
+    int picked = 0;
+    for (int i = size() - 1; i >= 0 && picked < count; i--) {
+        if (fadeDir_[i] < 0) continue;
+        if (fadeDir_[i] == 0) fading_++;
+        fadeDir_[i] = -1;
+        picked++;
+    }
+    retiring_ += picked;
+    return picked;
+}
+
+void DuckWeedField::update(int width, int height) {
+    int n = size();
+    // Points are pairs of floats; the integration treats them as one array
+    float *__restrict pos = &pos_.data()->x;
+    float *__restrict tar = &tar_.data()->x;
+    float *__restrict move = &move_.data()->x;
+    const float *__restrict radius = radius_.data();
+    int32_t *__restrict escaped = escaped_.data();
+    float w = (float)width;
+    float h = (float)height;
+
+    // 1. Flag weeds fully off the canvas, tested before easing
+    int32_t anyEscaped = 0;
+    for (int i = 0; i < n; i++) {
+        float x = pos[2 * i];
+        float y = pos[2 * i + 1];
+        int32_t out = (x + radius[i] < 0) | (x - radius[i] > w) |
+                      (y + radius[i] < 0) | (y - radius[i] > h);
+        escaped[i] = out;
+        anyEscaped |= out;
+    }
+
+    // 2. Drift the targets, damp the move vectors and ease towards the targets
+    for (int j = 0; j < 2 * n; j++) {
+        tar[j] += move[j];
+        move[j] *= 0.99f;
+        pos[j] += (tar[j] - pos[j]) * 0.1f;
+    }
+
+    // 3. Rare: teleport escaped weeds to a random position within bounds. The
+    // target matches the position, so the easing above has nothing to undo.
+    if (anyEscaped) {
+        for (int i = 0; i < n; i++) {
+            if (!escaped[i]) continue;
+            pos_[i] = { random_.range(0, width), random_.range(0, height) };
+            tar_[i] = pos_[i];
+            move_[i] = {0, 0};
+        }
+    }
+
+    // 4. Only while the population is changing
+    if (fading_ > 0) updateFades();
+}
+
+void DuckWeedField::updateFades() {
+    // Weeds that faded out are gone from the screen once trackDirty() has
+    // seen them at level 0, so they can go without leaving a dirty rect
+    if (retiring_ > 0) removeFaded();
+
+    if (++fadeTick_ < DUCKWEED_FADE_TICKS) return;
+    fadeTick_ = 0;
+    for (int i = 0; i < size(); i++) {
+        if (fadeDir_[i] == 0) continue;
+        int level = fade_[i] + fadeDir_[i];
+        if (level < 0) level = 0;
+        fade_[i] = (uint8_t)level;
+        if (fadeDir_[i] > 0 && level == DUCKWEED_FADE_STEPS) {
+            fadeDir_[i] = 0;
+            fading_--;
+        }
+    }
+}
+
+void DuckWeedField::removeFaded() {
+    int n = size();
+    int kept = 0;
+    for (int i = 0; i < n; i++) {
+        bool gone = fadeDir_[i] < 0 && fade_[i] == 0 && drawn_[i] && fadeDrawn_[i] == 0;
+        if (gone) {
+            fading_--;
+            retiring_--;
+            continue;
+        }
+        if (kept != i) {
+            pos_[kept] = pos_[i];
+            tar_[kept] = tar_[i];
+            move_[kept] = move_[i];
+            radius_[kept] = radius_[i];
+            vectorMax_[kept] = vectorMax_[i];
+            shape_[kept] = shape_[i];
+            xDrawn_[kept] = xDrawn_[i];
+            yDrawn_[kept] = yDrawn_[i];
+            drawn_[kept] = drawn_[i];
+            fadeDrawn_[kept] = fadeDrawn_[i];
+            fade_[kept] = fade_[i];
+            fadeDir_[kept] = fadeDir_[i];
+        }
+        kept++;
+    }
+    if (kept == n) return;
+    pos_.resize(kept);
+    tar_.resize(kept);
+    move_.resize(kept);
+    radius_.resize(kept);
+    vectorMax_.resize(kept);
+    shape_.resize(kept);
+    xDrawn_.resize(kept);
+    yDrawn_.resize(kept);
+    drawn_.resize(kept);
+    fadeDrawn_.resize(kept);
+    fade_.resize(kept);
+    fadeDir_.resize(kept);
+    escaped_.resize(kept);
+}
+
+void DuckWeedField::applyVector(int i, float x, float y, float strength) {
+    Point distVec = { pos_[i].x - x, pos_[i].y - y };
+    Point newVec = normalizeVector(distVec, strength);
+
+    Point resultVec = { newVec.x + move_[i].x, newVec.y + move_[i].y };
+    float magSq = resultVec.x * resultVec.x + resultVec.y * resultVec.y;
+    float vectorMax = vectorMax_[i];
+
+    if (magSq > vectorMax * vectorMax) {
+        resultVec = normalizeVector(resultVec, vectorMax);
+    }
+    move_[i] = resultVec;
+}
+
+void DuckWeedField::draw(int i, LGFX_Sprite* sprite) const {
+    int level = fade_[i];
+    if (level == 0) return;
+    stampOf(i).draw(sprite, stampX(i), stampY(i), fadeFill_[level], fadeStroke_[level]);
+}
+
+Rect DuckWeedField::getDirtyRect(int i) const {
+    return stampOf(i).bounds(stampX(i), stampY(i));
+}
+
+bool DuckWeedField::trackDirty(int i, Rect &previous, Rect &current) {
+    // The stamp is fixed, so the pixels only change when its integer
+    // position or its fade level does
+    previous = drawn_[i] ? stampOf(i).bounds(xDrawn_[i], yDrawn_[i]) : emptyRect();
+    current = getDirtyRect(i);
+    int x = stampX(i);
+    int y = stampY(i);
+    bool changed = !drawn_[i] || x != xDrawn_[i] || y != yDrawn_[i] || fade_[i] != fadeDrawn_[i];
+    xDrawn_[i] = (int16_t)x;
+    yDrawn_[i] = (int16_t)y;
+    fadeDrawn_[i] = fade_[i];
+    drawn_[i] = 1;
+    return changed;
+}
@@ -0,0 +1,98 @@
+#pragma once
+#include "../helper.h"
+#include "../Palette.h"
+#include "../Random.h"
+#include "../Stamp.h"
+#include <memory>
+#include <vector>
+
+// Radius buckets and outline variants in the shared stamp library
+#define DUCKWEED_RADIUS_STEP 0.5f
+#define DUCKWEED_SHAPE_VARIANTS 4
+#define DUCKWEED_SEGMENTS 4
+// Colour steps, and ticks per step, when a weed fades in or out
+#define DUCKWEED_FADE_STEPS 8
+#define DUCKWEED_FADE_TICKS 3
+
+// All duckweed in the pond, stored as parallel arrays so the per-frame
+// passes walk contiguous memory. Duckweed are a few pixels across, so they
+// share a small library of stamps keyed by radius bucket and outline variant
+// instead of each rasterizing its own.
+class DuckWeedField {
+    public:
+        // Builds the stamp library for radii in [minRadius, maxRadius]; seed
+        // drives outline shapes, variant choice and respawn positions. The
+        // RGB565 colours and their fade steps are inked through palette.
+        void begin(float minRadius, float maxRadius, uint16_t fillColor, uint16_t strokeColor, uint32_t seed, Palette &palette);
+        void clear();
+        void reserve(int count);
+        // Adds a weed that is fully visible straight away
+        void add(float x, float y, float radius);
+        // Adds a weed of random size and position that fades in
+        void spawn(int width, int height);
+        // Starts fading out up to count weeds, newest first; each is removed
+        // once it is invisible on screen. Returns how many were picked.
+        int retire(int count);
+
+        int size() const { return (int)pos_.size(); }
+        bool empty() const { return pos_.empty(); }
+        int capacity() const { return (int)pos_.capacity(); }
+        // Weeds not on their way out
+        int alive() const { return size() - retiring_; }
+
+        // Damping, integration and respawn of everything that left the
+        // canvas, then fading
+        void update(int width, int height);
+        void applyVector(int i, float x, float y, float strength);
+
+        Point getPosition(int i) const { return pos_[i]; }
+        float getRadius(int i) const { return radius_[i]; }
+
+        void draw(int i, LGFX_Sprite* sprite) const;
+        Rect getDirtyRect(int i) const;
+        bool trackDirty(int i, Rect &previous, Rect &current);
+
+    private:
+        // Position, target and move vector, as in the old per-object DuckWeed.
+        // x and y sit side by side so integration is one flat float loop and
+        // a scattered applyVector() touches few cache lines.
+        std::vector<Point> pos_;
+        std::vector<Point> tar_;
+        std::vector<Point> move_;
+        std::vector<float> radius_;
+        std::vector<float> vectorMax_;
+        std::vector<uint8_t> shape_;
+
+        // Stamp position and fade as of the last trackDirty() call
+        std::vector<int16_t> xDrawn_, yDrawn_;
+        std::vector<uint8_t> drawn_;
+        std::vector<uint8_t> fadeDrawn_;
+
+        // Fade level in 0..DUCKWEED_FADE_STEPS, and its direction (+1 in,
+        // -1 out, 0 settled). Only touched while something is fading.
+        std::vector<uint8_t> fade_;
+        std::vector<int8_t> fadeDir_;
+        int fading_ = 0;
+        int retiring_ = 0;
+        int fadeTick_ = 0;
+
+        // Scratch flags for weeds that left the canvas this update
+        std::vector<int32_t> escaped_;
+        Random random_;
+
+        // Shared with snapshots of the field; never modified after begin()
+        std::shared_ptr<const std::vector<Stamp>> stamps_;
+        float minRadius_ = 0;
+        float maxRadius_ = 0;
+        int radiusBuckets_ = 0;
+        // Colours per fade level, blended towards the black water
+        uint16_t fadeFill_[DUCKWEED_FADE_STEPS + 1] = {};
+        uint16_t fadeStroke_[DUCKWEED_FADE_STEPS + 1] = {};
+
+        void updateFades();
+        void removeFaded();
+
+        int stampX(int i) const { return (int)floorf(pos_[i].x + 0.5f); }
+        int stampY(int i) const { return (int)floorf(pos_[i].y + 0.5f); }
+        const Stamp& stampOf(int i) const { return (*stamps_)[shape_[i]]; }
+};
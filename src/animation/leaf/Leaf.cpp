@@ -1,33 +1,39 @@
 #include "Leaf.h"
 #include "../helper.h"
 
-Leaf::Leaf(float x, float y, float radius, int segments, uint32_t fillColor, uint32_t strokeColor) 
+Leaf::Leaf(float x, float y, float radius, int segments, Random &random, uint32_t fillColor, uint32_t strokeColor) 
     : radius_(radius), xOrg_(x), yOrg_(y), xCur_(x), yCur_(y), xTar_(x), yTar_(y), fillColor_(fillColor), strokeColor_(strokeColor)
 {
-    float firstPointRadian = randomFloat(0, 2 * PI);
+    float firstPointRadian = random.range(0, 2 * PI);
     float segmentRadian = (2 * PI) / segments;
 
+    std::vector<Point> outline;
     for (int i = 0; i < segments; i++) {
-        float len = (i == 0) ? randomFloat(radius * 0.1f, radius * 0.2f) : randomFloat(radius * 0.96f, radius * 1.04f);
+        float len = (i == 0) ? random.range(radius * 0.1f, radius * 0.2f) : random.range(radius * 0.96f, radius * 1.04f);
         float radian = firstPointRadian + segmentRadian * i;
-        points_.push_back({len, radian});
+        outline.push_back(findPosition({0, 0}, radian, len));
     }
+    stamp_ = Stamp::fromOutline(outline.data(), outline.size());
     
     oscillateMax_ = radius * 0.4f;
 }
 
 void Leaf::update() {
-    float acc = sqrt(pow(oscillateVector_.x, 2) + pow(oscillateVector_.y, 2));
+    float acc = mathSqrt(oscillateVector_.x * oscillateVector_.x + oscillateVector_.y * oscillateVector_.y);
     frameCount_ += 0.1f * log(0.01f * acc + 1.0f);
     
-    float xOffset = sin(frameCount_) * oscillateVector_.x;
-    float yOffset = sin(frameCount_) * oscillateVector_.y;
+    float wave = mathSin(frameCount_);
+    float xOffset = wave * oscillateVector_.x;
+    float yOffset = wave * oscillateVector_.y;
     
     xTar_ = xOrg_ + xOffset;
     yTar_ = yOrg_ + yOffset;
 
     oscillateVector_.x *= 0.99f;
     oscillateVector_.y *= 0.99f;
+
+    xCur_ += (xTar_ - xCur_) * 0.1f;
+    yCur_ += (yTar_ - yCur_) * 0.1f;
 }
 
 void Leaf::applyOscillation(float x, float y, float strength) {
@@ -35,61 +41,36 @@ void Leaf::applyOscillation(float x, float y, float strength) {
     Point newVec = normalizeVector(distVec, strength);
     
     Point resultVec = { newVec.x + oscillateVector_.x, newVec.y + oscillateVector_.y };
-    float mag = sqrt(pow(resultVec.x, 2) + pow(resultVec.y, 2));
+    float magSq = resultVec.x * resultVec.x + resultVec.y * resultVec.y;
     
-    if (mag > oscillateMax_) {
+    if (magSq > oscillateMax_ * oscillateMax_) {
         resultVec = normalizeVector(resultVec, oscillateMax_);
     }
     oscillateVector_ = resultVec;
 }
 
 void Leaf::draw(LGFX_Sprite* sprite) {
-    xCur_ += (xTar_ - xCur_) * 0.1f;
-    yCur_ += (yTar_ - yCur_) * 0.1f;
-
-    if (points_.empty()) return;
-
-    std::vector<Point> renderPoints;
-    for (const auto& p : points_) {
-        renderPoints.push_back(findPosition({xCur_, yCur_}, p.radian, p.length));
-    }
-
-    int len = renderPoints.size();
-    Point pLast = renderPoints[len - 1];
-    Point pStart = { (renderPoints[0].x + pLast.x)/2.0f, (renderPoints[0].y + pLast.y)/2.0f };
-    
-    Point currentP = pStart;
-
-    // Fill curves
-    Point anchor = {xCur_, yCur_};
-    Point pEnd = renderPoints[len-1];
-    for (int i = 0; i < len - 1; i++) {
-        Point p1 = renderPoints[i];
-        Point p2 = renderPoints[i+1];
-        Point mid = { (p1.x + p2.x)/2.0f, (p1.y + p2.y)/2.0f };
-        
-        // Use the fill helper
-        fillQuadraticBezier(sprite, anchor, currentP.x, currentP.y, p1.x, p1.y, mid.x, mid.y, fillColor_);
-        currentP = mid;
-    }
-    fillQuadraticBezier(sprite, anchor, currentP.x, currentP.y, pEnd.x, pEnd.y, pStart.x, pStart.y, fillColor_);
-
-    currentP = pStart;
-    Point firstPoint = renderPoints[0];
-    // Drawing closed loop
-    for (int i = 0; i < len - 1; i++) {
-        Point p1 = renderPoints[i];
-        Point p2 = renderPoints[i+1];
-        Point mid = { (p1.x + p2.x)/2.0f, (p1.y + p2.y)/2.0f };
-        
-        drawQuadraticBezier(sprite, currentP.x, currentP.y, p1.x, p1.y, mid.x, mid.y, strokeColor_);
-        currentP = mid;
-    }
-    
-    // Close the loop
-    drawQuadraticBezier(sprite, currentP.x, currentP.y, pEnd.x, pEnd.y, pStart.x, pStart.y, strokeColor_);
+    stamp_->draw(sprite, stampX(), stampY(), fillColor_, strokeColor_);
 }
 
 Point Leaf::getPosition() const {
     return {xCur_, yCur_};
+}
+
+Rect Leaf::getDirtyRect() const {
+    return stamp_->bounds(stampX(), stampY());
+}
+
+bool Leaf::trackDirty(Rect &previous, Rect &current) {
+    // The stamp is fixed, so the pixels only change when its integer position does
+    previous = drawnRect_;
+    current = getDirtyRect();
+    int x = stampX();
+    int y = stampY();
+    bool moved = !drawn_ || x != xDrawn_ || y != yDrawn_;
+    xDrawn_ = x;
+    yDrawn_ = y;
+    drawn_ = true;
+    drawnRect_ = current;
+    return moved;
 }
\ No newline at end of file
@@ -1,20 +1,22 @@
 #pragma once
 #include "../helper.h"
+#include "../Random.h"
+#include "../Stamp.h"
 #include <vector>
 
-struct LeafPoint {
-    float length;
-    float radian;
-};
-
 class Leaf {
     public:
-        Leaf(float x, float y, float radius, int segments, uint32_t fillColor = TFT_WHITE, uint32_t strokeColor = TFT_BLACK);
+        // The outline is drawn from random; the leaf keeps no generator
+        Leaf(float x, float y, float radius, int segments, Random &random, uint32_t fillColor = TFT_WHITE, uint32_t strokeColor = TFT_BLACK);
         void update();
         void applyOscillation(float x, float y, float strength);
         void draw(LGFX_Sprite* sprite);
         Point getPosition() const;
+        int stampX() const { return (int)floorf(xCur_ + 0.5f); }
+        int stampY() const { return (int)floorf(yCur_ + 0.5f); }
         float getRadius() const { return radius_; }
+        Rect getDirtyRect() const;
+        bool trackDirty(Rect &previous, Rect &current);
 
     private:
         float radius_;
@@ -22,8 +24,14 @@ class Leaf {
         float xOrg_, yOrg_;
         float xCur_, yCur_;
         float xTar_, yTar_;
+
+        // Stamp position and rect as of the last trackDirty() call
+        int xDrawn_ = 0, yDrawn_ = 0;
+        bool drawn_ = false;
+        Rect drawnRect_ = {0, 0, 0, 0};
         
-        std::vector<LeafPoint> points_;
+        // Rasterized once; shared by copies of this Leaf
+        std::shared_ptr<const Stamp> stamp_;
         float frameCount_ = 0;
         
         Point oscillateVector_ = {0, 0};
@@ -4,7 +4,6 @@ Ripple::Ripple(float x, float y, float intensity, float initialRadius)
     : x_(x), y_(y), maxIntensity_(intensity)
 {
     speed_ = intensity / 50.0f; // TS logic
-    startMillis_ = millis();
     
     // Map intensity to number of ripples (0 to 3)
     remainingRipples_ = floor(map(intensity, 0, 255, 0, 3));
@@ -19,9 +18,9 @@ Ripple::Ripple(float x, float y, float intensity, float initialRadius)
     rings_.push_back(firstRing);
 }
 
-bool Ripple::update() {
+bool Ripple::update(unsigned long stepMillis) {
     // 1. Spawn new rings (Double Trigger logic)
-    if (remainingRipples_ > 0 && (millis() - startMillis_ > interval_)) {
+    if (remainingRipples_ > 0 && ringAgeMillis_ > interval_) {
         RippleRing newRing;
         newRing.currentIntensity = maxIntensity_; // Use stored max intensity
         newRing.currentRadius = 0;
@@ -30,43 +29,51 @@ bool Ripple::update() {
         newRing.edgeT = y_; newRing.edgeB = y_;
         
         rings_.push_back(newRing);
-        startMillis_ = millis();
+        ringAgeMillis_ = 0;
         remainingRipples_--;
     }
+    ringAgeMillis_ += stepMillis;
 
     // 2. Update existing rings
-    for (int i = rings_.size() - 1; i >= 0; i--) {
-        RippleRing& r = rings_[i];
-        
+    for (auto& r : rings_) {
         r.currentIntensity -= speed_;
         r.targetRadius += speed_ * 2.0f;
         // Smooth expansion
         r.currentRadius = lerp(r.currentRadius, r.targetRadius, 0.1f);
-
-        if (r.currentIntensity <= 0) {
-            rings_.erase(rings_.begin() + i);
-        }
     }
+    rings_.removeIf([](const RippleRing &r) { return r.currentIntensity <= 0; });
 
     return !rings_.empty();
 }
 
-void Ripple::draw(LGFX_Sprite* sprite) {
+void Ripple::draw(LGFX_Sprite* sprite, const uint16_t *grayInk) {
     for (const auto& r : rings_) {
         if (r.currentIntensity <= 0) continue;
 
         uint8_t b = (uint8_t)map(r.currentIntensity, 0, 100, 0, 255);
-        
-        // 16-bit Grayscale
-        uint16_t color = sprite->color565(b, b, b);
-        
-        sprite->drawCircle((int)x_, (int)y_, (int)r.currentRadius, color);
+        sprite->drawCircle((int)x_, (int)y_, (int)r.currentRadius, grayInk[b]);
     }
 }
 
-std::vector<Ripple> Ripple::detectBouncing(int width, int height) {
-    std::vector<Ripple> newRipples;
+Rect Ripple::getDirtyRect() const {
+    float maxRadius = -1.0f;
+    for (const auto& r : rings_) {
+        if (r.currentIntensity <= 0) continue;
+        if (r.currentRadius > maxRadius) maxRadius = r.currentRadius;
+    }
+    if (maxRadius < 0) return emptyRect();
+    return rectAround(x_, y_, maxRadius);
+}
+
+bool Ripple::trackDirty(Rect &previous, Rect &current) {
+    // Rings grow and fade on every update while the ripple is alive
+    previous = drawnRect_;
+    current = getDirtyRect();
+    drawnRect_ = current;
+    return true;
+}
 
+void Ripple::detectBouncing(int width, int height, RipplePool &newRipples) {
     for (auto& r : rings_) {
         float curL = x_ - r.currentRadius;
         float curR = x_ + r.currentRadius;
@@ -96,5 +103,4 @@ std::vector<Ripple> Ripple::detectBouncing(int width, int height) {
         r.edgeL = curL; r.edgeR = curR;
         r.edgeT = curT; r.edgeB = curB;
     }
-    return newRipples;
 }
\ No newline at end of file
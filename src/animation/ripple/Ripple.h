@@ -1,7 +1,13 @@
 #pragma once
 #include <LovyanGFX.hpp>
-#include <vector>
 #include "../helper.h"
+#include "../FixedVector.h"
+
+// Fixed pool sizes; a ripple spawns at most 1 + intensity/85 rings and
+// bounces are dropped once the pool is full. Random ripples live well under
+// the shortest cadence, so a few slots are plenty; scene copies carry them all.
+#define RIPPLE_MAX_RINGS 4
+#define MAX_RIPPLES 8
 
 // Individual ring within a Ripple effect
 struct RippleRing {
@@ -12,31 +18,44 @@ struct RippleRing {
     float edgeL, edgeR, edgeT, edgeB; 
 };
 
+class Ripple;
+typedef FixedVector<RippleRing, RIPPLE_MAX_RINGS> RippleRings;
+typedef FixedVector<Ripple, MAX_RIPPLES> RipplePool;
+
 class Ripple {
     public:
+        Ripple() = default;
         Ripple(float x, float y, float intensity, float initialRadius = 0);
         
-        // Returns false if all rings have faded
-        bool update(); 
-        void draw(LGFX_Sprite* sprite);
+        // Advances one simulation step of stepMillis; returns false if all
+        // rings have faded
+        bool update(unsigned long stepMillis);
+        // grayInk[b] is the sprite colour for grey level b (0-255)
+        void draw(LGFX_Sprite* sprite, const uint16_t *grayInk);
         
-        // Returns a vector of NEW ripples generated by bouncing
-        std::vector<Ripple> detectBouncing(int width, int height);
+        // Appends the NEW ripples generated by bouncing to `out`
+        void detectBouncing(int width, int height, RipplePool &out);
 
         // Getters for collision detection
         float getX() const { return x_; }
         float getY() const { return y_; }
-        const std::vector<RippleRing>& getRings() const { return rings_; }
+        const RippleRings& getRings() const { return rings_; }
+        Rect getDirtyRect() const;
+        bool trackDirty(Rect &previous, Rect &current);
+        // Rect from the last trackDirty() call, still on screen after death
+        const Rect& getDrawnRect() const { return drawnRect_; }
 
     private:
-        float x_, y_;
-        float maxIntensity_;
-        float speed_;
+        float x_ = 0, y_ = 0;
+        float maxIntensity_ = 0;
+        float speed_ = 0;
         
-        // Spawning logic
-        unsigned long startMillis_;
-        int remainingRipples_;
+        // Spawning logic; simulated time since the last ring as of the
+        // next update
+        unsigned long ringAgeMillis_ = 0;
+        int remainingRipples_ = 0;
         unsigned long interval_ = 150; // ms between rings
 
-        std::vector<RippleRing> rings_;
+        RippleRings rings_;
+        Rect drawnRect_ = {0, 0, 0, 0};
 };
\ No newline at end of file
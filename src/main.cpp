@@ -20,7 +20,13 @@ static LGFX_Sprite _sprites[2] = { LGFX_Sprite(&lcd), LGFX_Sprite(&lcd) };
 #define LED_PIN 46
 #define LED_COUNT 3
 
+// Duckweed range the density governor may use with POND_TARGET_FPS
+#define GOVERNED_MIN_DUCKWEEDS 20
+#define GOVERNED_MAX_DUCKWEEDS 150
+
 Adafruit_NeoPixel pixels = Adafruit_NeoPixel(LED_COUNT, LED_PIN, NEO_GRB + NEO_KHZ800);
+// Sends LED frames without holding up the loop; pixels only sizes the strip
+RmtLedBus ledBus(LED_PIN);
 ButtonGroup buttonGroup;
 Controller controller(lcd,
                       &_sprites[0], 
@@ -35,9 +41,50 @@ void setup() {
     buttonGroup.setBottomPin(Bottom_BUTTON_PIN);
     buttonGroup.setSpreadPin(SPREAD_BUTTON_PIN); // Setup Spread Button
 
+#ifdef POND_PROFILE
+    // Periodic per-phase timing report
+    Serial.begin(115200);
+#endif
+#ifdef POND_PROFILE_HUD
+    controller.setProfileHud(true);
+#endif
+
+    controller.setLedBus(&ledBus);
+    // Koi and comets share the pond
+    controller.setSpecies(FISH_SPECIES, FISH_SPECIES_COUNT);
+
+#ifdef POND_TARGET_FPS
+    controller.setTargetFps(POND_TARGET_FPS, GOVERNED_MIN_DUCKWEEDS, GOVERNED_MAX_DUCKWEEDS);
+#endif
+#ifdef POND_FISH_BUDGET_US
+    controller.setFishDetailBudget(POND_FISH_BUDGET_US);
+#endif
+
+#ifdef POND_INDEXED_COLOR
+    // 8-bit palette sprites; ignored with POND_BAND_RENDER
+    controller.setIndexedColor(true);
+#endif
+#ifdef POND_BAND_RENDER
+    // The two sprites shrink to BAND_HEIGHT strips
+    controller.setBandRendering(true);
+#endif
+
+#ifndef POND_PIPELINED
+    // Stream each frame out from the other core while the loop simulates
+    controller.setPushTask(true);
+#endif
+
     controller.begin();
+#ifdef POND_PIPELINED
+    controller.startPipeline();
+#endif
 }
 
 void loop() {
+#ifdef POND_PIPELINED
+  // Simulation and rendering run on their own pinned tasks
+  vTaskDelete(NULL);
+#else
   controller.service();
+#endif
 }
\ No newline at end of file
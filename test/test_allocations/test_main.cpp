@@ -0,0 +1,166 @@
+// Once warmed up, a frame must not touch the heap: every container is sized
+// up front and pools fail rather than grow. Global operator new, and on
+// glibc malloc itself, are replaced with counting versions; a pond runs a
+// while to settle, then the frames after that must allocate nothing.
+//
+//   pio test -e native -f test_allocations
+#include <Arduino.h>
+#include <unity.h>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+#include "ButtonGroup.h"
+#include "Controller.h"
+#include <Adafruit_NeoPixel.h>
+#include <config.hpp>
+
+#define LEFT_BUTTON_PIN 21
+#define RIGHT_BUTTON_PIN 26
+#define Bottom_BUTTON_PIN 33
+#define SPREAD_BUTTON_PIN 34
+
+#define WARMUP_FRAMES 100
+// Long enough to run the whole press script: spread, ripples, turns
+#define MEASURED_FRAMES 960
+#define SCRIPT_PERIOD 480
+
+static std::atomic<bool> counting{false};
+static std::atomic<uint32_t> allocations{0};
+
+static void *countedAlloc(std::size_t size) {
+    if (counting.load(std::memory_order_relaxed)) allocations++;
+    void *p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new(std::size_t size) { return countedAlloc(size); }
+void *operator new[](std::size_t size) { return countedAlloc(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    if (counting.load(std::memory_order_relaxed)) allocations++;
+    return std::malloc(size ? size : 1);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept { return operator new(size, tag); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+#ifdef __GLIBC__
+// C allocations too, for anything that bypasses operator new
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *p, size_t size);
+
+void *malloc(size_t size) {
+    if (counting.load(std::memory_order_relaxed)) allocations++;
+    return __libc_malloc(size);
+}
+void *calloc(size_t count, size_t size) {
+    if (counting.load(std::memory_order_relaxed)) allocations++;
+    return __libc_calloc(count, size);
+}
+void *realloc(void *p, size_t size) {
+    if (counting.load(std::memory_order_relaxed)) allocations++;
+    return __libc_realloc(p, size);
+}
+}
+#endif
+
+struct ScriptedPress {
+    uint8_t pin;
+    int from;
+    int to;
+};
+
+// Same presses as native/bench
+static const ScriptedPress SCRIPT[] = {
+    {LEFT_BUTTON_PIN, 60, 150},
+    {RIGHT_BUTTON_PIN, 180, 270},
+    {Bottom_BUTTON_PIN, 300, 390},
+    {SPREAD_BUTTON_PIN, 420, 430},
+};
+
+enum RenderMode { SEQUENTIAL, BANDS, INDEXED };
+
+struct Pond {
+    LGFX lcd;
+    LGFX_Sprite sprites[2] = { LGFX_Sprite(&lcd), LGFX_Sprite(&lcd) };
+    Adafruit_NeoPixel pixels{3, 46, NEO_GRB + NEO_KHZ800};
+    ButtonGroup buttons;
+    Controller controller{lcd, &sprites[0], &sprites[1], buttons, pixels};
+};
+
+static void runFrame(Pond &pond, int frame) {
+    int t = frame % SCRIPT_PERIOD;
+    for (const ScriptedPress &p : SCRIPT) hostSetPin(p.pin, (t >= p.from && t < p.to) ? LOW : HIGH);
+    hostAdvanceMillis(SIM_TICK_MS);
+    pond.controller.service();
+}
+
+static uint32_t allocationsAfterWarmup(RenderMode mode) {
+    std::unique_ptr<Pond> pond(new Pond());
+    pond->buttons.setLeftPin(LEFT_BUTTON_PIN);
+    pond->buttons.setRightPin(RIGHT_BUTTON_PIN);
+    pond->buttons.setBottomPin(Bottom_BUTTON_PIN);
+    pond->buttons.setSpreadPin(SPREAD_BUTTON_PIN);
+    pond->controller.setBandRendering(mode == BANDS);
+    pond->controller.setIndexedColor(mode == INDEXED);
+    pond->controller.setSpecies(FISH_SPECIES, FISH_SPECIES_COUNT);
+    pond->controller.setSeed(1);
+    pond->controller.begin();
+
+    int frame = 0;
+    for (; frame < WARMUP_FRAMES; frame++) runFrame(*pond, frame);
+    allocations = 0;
+    counting = true;
+    for (; frame < WARMUP_FRAMES + MEASURED_FRAMES; frame++) runFrame(*pond, frame);
+    counting = false;
+
+    for (const ScriptedPress &p : SCRIPT) hostSetPin(p.pin, HIGH);
+    return allocations.load();
+}
+
+static void test_sequential_frames_do_not_allocate() {
+    TEST_ASSERT_EQUAL_UINT32(0, allocationsAfterWarmup(SEQUENTIAL));
+}
+
+static void test_band_frames_do_not_allocate() {
+    TEST_ASSERT_EQUAL_UINT32(0, allocationsAfterWarmup(BANDS));
+}
+
+static void test_indexed_frames_do_not_allocate() {
+    TEST_ASSERT_EQUAL_UINT32(0, allocationsAfterWarmup(INDEXED));
+}
+
+// The hooks must see allocations at all, or the tests above prove nothing
+static void test_hooks_count_allocations() {
+    allocations = 0;
+    counting = true;
+    std::unique_ptr<int> boxed(new int(1));
+    void *raw = std::malloc(16);
+    counting = false;
+    std::free(raw);
+#ifdef __GLIBC__
+    // new counts once itself and once in the malloc under it
+    TEST_ASSERT_EQUAL_UINT32(3, allocations.load());
+#else
+    TEST_ASSERT_EQUAL_UINT32(1, allocations.load());
+#endif
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv) {
+    hostUseManualClock(true);
+    UNITY_BEGIN();
+    RUN_TEST(test_hooks_count_allocations);
+    RUN_TEST(test_sequential_frames_do_not_allocate);
+    RUN_TEST(test_band_frames_do_not_allocate);
+    RUN_TEST(test_indexed_frames_do_not_allocate);
+    return UNITY_END();
+}
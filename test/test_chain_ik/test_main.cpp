@@ -0,0 +1,256 @@
+// Chain<N> solves its links with vectors; ReferenceChain below keeps the
+// angle-based solver it replaced (Circle::followBody, applyPullingForce and
+// applyAngleConstrain), so the two can be run side by side and compared
+// joint by joint.
+//
+//   pio test -e native -f test_chain_ik
+#include <Arduino.h>
+#include <unity.h>
+#include <algorithm>
+#include <vector>
+
+#include "animation/Random.h"
+#include "animation/fish/Chain.h"
+#include "animation/fish/Cube.h"
+#include "animation/fish/FishSpecies.h"
+
+// Single steps: share of links within SINGLE_STEP_TOLERANCE of the reference,
+// and the worst link. The few misses sit on the old solver's own
+// discontinuities: the easing's 2*pi branch cut and the fold side at
+// exactly straight.
+#define SINGLE_STEP_TRIALS 20000
+#define SINGLE_STEP_TOLERANCE 0.01f
+#define SINGLE_STEP_MIN_SHARE 0.999f
+#define SINGLE_STEP_WORST 0.16f
+// Long runs: every joint of every chain on every tick, body and fin
+#define RUN_CHAINS 8
+#define RUN_TICKS 3000
+#define RUN_P99 0.014f
+
+#define WIDTH 320
+#define HEIGHT 240
+#define GAP 4.0f
+
+template <int N>
+class ReferenceChain {
+    public:
+        ReferenceChain(const Circle *joints, float gap, float angle) : gap_(gap) {
+            smallestAngle_ = angle * PI / 180.0f;
+            for (int i = 0; i < N; i++) circles_[i] = joints[i];
+        }
+
+        void freeMove(float x, float y, int width, int height) {
+            float acceleration = circles_[0].followPoint(x, y, width, height);
+            frameCount_ += 25.0f * log(0.3f * acceleration + 1.0f);
+            float oscillateScale = (PI / 5.0f) * log(2.0f * acceleration + 1.0f);
+            for (int i = 1; i < N; i++) {
+                float oscillateOffset = i * N * PI * 1.1368f;
+                float mapVal = map((float)i, 0.0f, (float)N, 0.5f, 3.0f);
+                float oscillateRadian = mathSin(frameCount_ + oscillateOffset) * oscillateScale * mapVal;
+                followBody(i, &oscillateRadian);
+            }
+        }
+
+        void constrainMove(float x, float y, float idealRadian, float constrainStrength) {
+            circles_[0].teleport(x, y);
+            Point idealPosition = {x + gap_ * mathCos(idealRadian), y + gap_ * mathSin(idealRadian)};
+            Point pos0 = {x, y};
+            Point pos1 = circles_[1].getPosition();
+            float deltaRadian = findAngleBetween(pos0, pos1, idealPosition);
+            float currentRadian = findTangent(pos0, pos1);
+            int dir = isOnLeft(pos0, idealPosition, pos1) ? -1 : 1;
+            float radian = currentRadian + dir * deltaRadian * constrainStrength;
+            circles_[1].teleport(x + gap_ * mathCos(radian), y + gap_ * mathSin(radian));
+            for (int i = 2; i < N; i++) followBody(i, nullptr);
+        }
+
+        void simpleMove(float x, float y, int width, int height) {
+            circles_[0].followPoint(x, y, width, height);
+            for (int i = 1; i < N; i++) followBody(i, nullptr);
+        }
+
+        Point position(int i) const { return circles_[i].getPosition(); }
+
+    private:
+        Circle circles_[N];
+        float gap_;
+        float smallestAngle_;
+        float frameCount_ = 0;
+
+        void followBody(int i, const float *oscillateRadian) {
+            Point target = circles_[i - 1].getPosition();
+            Point self = circles_[i].getPosition();
+            Point direction = normalizeVector({self.x - target.x, self.y - target.y}, gap_);
+            if (oscillateRadian) {
+                float c = mathCos(*oscillateRadian);
+                float s = mathSin(*oscillateRadian);
+                direction = {direction.x * c - direction.y * s, direction.x * s + direction.y * c};
+            }
+            self = {target.x + direction.x, target.y + direction.y};
+            if (i >= 2) self = applyAngleConstrain(self, target, circles_[i - 2].getPosition());
+            circles_[i].teleport(self.x, self.y);
+        }
+
+        Point applyAngleConstrain(Point self, const Point &center, const Point &other) const {
+            float radianDelta = findAngleBetween(center, self, other);
+            if (radianDelta < smallestAngle_) {
+                float otherRadian = findTangent(center, other);
+                float radian = isOnLeft(center, other, self) ? otherRadian + smallestAngle_ : otherRadian - smallestAngle_;
+                self = {center.x + gap_ * mathCos(radian), center.y + gap_ * mathSin(radian)};
+            }
+            if (radianDelta != PI) {
+                float targetRadian = findTangent(other, center) + PI;
+                float currentRadian = findTangent(center, self);
+                float radianDiff = fabsf(targetRadian - currentRadian);
+                float radian = isOnLeft(center, other, self) ? currentRadian + radianDiff * 0.001f
+                                                             : currentRadian - radianDiff * 0.001f;
+                self = {center.x + gap_ * mathCos(radian), center.y + gap_ * mathSin(radian)};
+            }
+            return self;
+        }
+};
+
+static float deviation(const Point &a, const Point &b) {
+    return hypotf(a.x - b.x, a.y - b.y);
+}
+
+// Lays a chain out as a random bent line, jittered off its gaps
+template <int N>
+static void scatter(Circle *joints, Random &random) {
+    float angle = random.range(-PI, PI);
+    Point p = {random.range(40, WIDTH - 40), random.range(40, HEIGHT - 40)};
+    for (int i = 0; i < N; i++) {
+        joints[i] = Circle(p.x, p.y, 3);
+        angle += random.range(-0.6f, 0.6f);
+        p.x += GAP * cosf(angle) + random.range(-0.5f, 0.5f);
+        p.y += GAP * sinf(angle) + random.range(-0.5f, 0.5f);
+    }
+}
+
+enum Move { FREE_MOVE, SIMPLE_MOVE, CONSTRAIN_MOVE };
+
+static void singleSteps(Move move) {
+    const float sizes[FISH_BODY_JOINTS] = {};
+    Random random(3);
+    std::vector<float> deviations;
+    for (int trial = 0; trial < SINGLE_STEP_TRIALS; trial++) {
+        Circle joints[FISH_BODY_JOINTS];
+        Chain<FISH_BODY_JOINTS> chain(joints, 0, 0, 0, GAP, 165.0f, sizes);
+        scatter<FISH_BODY_JOINTS>(joints, random);
+        ReferenceChain<FISH_BODY_JOINTS> reference(joints, GAP, 165.0f);
+
+        Point head = joints[0].getPosition();
+        float x = head.x + random.range(-60, 60), y = head.y + random.range(-60, 60);
+        if (move == FREE_MOVE) {
+            chain.freeMove(x, y, WIDTH, HEIGHT);
+            reference.freeMove(x, y, WIDTH, HEIGHT);
+        } else if (move == SIMPLE_MOVE) {
+            chain.simpleMove(x, y, WIDTH, HEIGHT);
+            reference.simpleMove(x, y, WIDTH, HEIGHT);
+        } else {
+            float ideal = random.range(-PI, PI);
+            float strength = random.range(0.0f, 1.0f);
+            x = head.x;
+            y = head.y;
+            chain.constrainMove(x, y, {cosf(ideal), sinf(ideal)}, strength);
+            reference.constrainMove(x, y, ideal, strength);
+        }
+        for (int i = 1; i < FISH_BODY_JOINTS; i++) {
+            deviations.push_back(deviation(chain.getCircle(i).getPosition(), reference.position(i)));
+        }
+    }
+
+    int within = 0;
+    float worst = 0;
+    for (float d : deviations) {
+        if (d <= SINGLE_STEP_TOLERANCE) within++;
+        worst = fmaxf(worst, d);
+    }
+    float share = (float)within / deviations.size();
+    char message[96];
+    snprintf(message, sizeof(message), "%.4f%% of links within %.2f px, worst %.4f px",
+             100 * share, SINGLE_STEP_TOLERANCE, worst);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE_MESSAGE(share >= SINGLE_STEP_MIN_SHARE, message);
+    TEST_ASSERT_LESS_OR_EQUAL_FLOAT(SINGLE_STEP_WORST, worst);
+}
+
+static void test_free_move_step_matches_reference() { singleSteps(FREE_MOVE); }
+static void test_simple_move_step_matches_reference() { singleSteps(SIMPLE_MOVE); }
+static void test_constrain_move_step_matches_reference() { singleSteps(CONSTRAIN_MOVE); }
+
+// Fish-shaped pairs of chains run for RUN_TICKS, each side on its own: the
+// body follows a Cube the way Fish::update drives it, dashing and steered
+// now and then, and a fin hangs off the body at an angle
+static void test_long_run_stays_with_reference() {
+    const float bodySizes[FISH_BODY_JOINTS] = {};
+    const float finSizes[FISH_FIN_JOINTS] = {};
+    Random random(7);
+    std::vector<float> deviations;
+    float worst = 0;
+
+    for (int c = 0; c < RUN_CHAINS; c++) {
+        float x = random.range(0, WIDTH), y = random.range(0, HEIGHT);
+        float length = random.range(40, 70), width = random.range(12, 20);
+        float gap = length / FISH_BODY_JOINTS;
+        float finGap = gap * 2.5f * (width / length);
+        float finRadian = random.range(0.5f, 1.5f);
+        float finStrength = random.range(0.3f, 0.8f);
+        Cube cube(x, y, width * 0.15f, random.fork());
+
+        Circle joints[FISH_BODY_JOINTS + FISH_FIN_JOINTS];
+        Chain<FISH_BODY_JOINTS> body(joints, 0, x, y, gap, 165.0f, bodySizes);
+        Chain<FISH_FIN_JOINTS> fin(joints, FISH_BODY_JOINTS, x, y, finGap, 160.0f, finSizes);
+        ReferenceChain<FISH_BODY_JOINTS> bodyReference(joints, gap, 165.0f);
+        ReferenceChain<FISH_FIN_JOINTS> finReference(joints + FISH_BODY_JOINTS, finGap, 160.0f);
+        Point turn = {cosf(finRadian), sinf(finRadian)};
+
+        for (int tick = 0; tick < RUN_TICKS; tick++) {
+            if ((tick + c * 37) % 200 == 0) cube.dash(random.range(-PI, PI));
+            if (tick % 500 < 100) cube.move(2, 1);
+            cube.update(WIDTH, HEIGHT);
+            Point pos = cube.getPosition();
+            body.freeMove(pos.x, pos.y, WIDTH, HEIGHT);
+            bodyReference.freeMove(pos.x, pos.y, WIDTH, HEIGHT);
+
+            // As Fish::finHeading, and as the old Fish::update did with angles
+            Point start = body.getCircle(2).getPosition();
+            Point next = body.getCircle(3).getPosition();
+            Point d = normalizeVector({next.x - start.x, next.y - start.y}, 1.0f);
+            fin.constrainMove(start.x, start.y,
+                              {d.x * turn.x - d.y * turn.y, d.x * turn.y + d.y * turn.x}, finStrength);
+            Point referenceStart = bodyReference.position(2);
+            float heading = findTangent(referenceStart, bodyReference.position(3)) + finRadian;
+            finReference.constrainMove(referenceStart.x, referenceStart.y, heading, finStrength);
+
+            for (int i = 1; i < FISH_BODY_JOINTS; i++) {
+                deviations.push_back(deviation(body.getCircle(i).getPosition(), bodyReference.position(i)));
+            }
+            for (int i = 1; i < FISH_FIN_JOINTS; i++) {
+                deviations.push_back(deviation(fin.getCircle(i).getPosition(), finReference.position(i)));
+            }
+        }
+    }
+
+    for (float d : deviations) worst = fmaxf(worst, d);
+    size_t rank = deviations.size() * 99 / 100;
+    std::nth_element(deviations.begin(), deviations.begin() + rank, deviations.end());
+    float p99 = deviations[rank];
+    char message[96];
+    snprintf(message, sizeof(message), "%zu joint positions: p99 %.4f px, worst %.4f px",
+             deviations.size(), p99, worst);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_LESS_OR_EQUAL_FLOAT(RUN_P99, p99);
+}
+
+void setUp() {}
+void tearDown() {}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_free_move_step_matches_reference);
+    RUN_TEST(test_simple_move_step_matches_reference);
+    RUN_TEST(test_constrain_move_step_matches_reference);
+    RUN_TEST(test_long_run_stays_with_reference);
+    return UNITY_END();
+}
@@ -0,0 +1,110 @@
+// FrameHandoff with a real producer and consumer thread. Each frame is
+// filled with its sequence number, so a frame the producer writes while the
+// consumer holds it shows up as mixed or changed words, and a stale one as a
+// sequence number that went backwards. Build it with ThreadSanitizer too:
+//
+//   pio test -e native -f test_frame_handoff
+//   pio test -e native_tsan
+#include <Arduino.h>
+#include <unity.h>
+#include <atomic>
+#include <thread>
+
+#include "FrameHandoff.h"
+
+#define FRAME_WORDS 64
+#define FRAMES 50000
+
+struct Frame {
+    uint32_t sequence;
+    uint32_t words[FRAME_WORDS];
+};
+
+static void fillFrame(Frame &frame, uint32_t sequence) {
+    frame.sequence = sequence;
+    for (int i = 0; i < FRAME_WORDS; i++) frame.words[i] = sequence * 2654435761u + i;
+}
+
+static bool frameIntact(const Frame &frame) {
+    for (int i = 0; i < FRAME_WORDS; i++) {
+        if (frame.words[i] != frame.sequence * 2654435761u + i) return false;
+    }
+    return true;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_publish_reports_replaced_frame() {
+    FrameHandoff<Frame> handoff;
+    TEST_ASSERT_FALSE(handoff.acquire());
+
+    fillFrame(handoff.back(), 1);
+    TEST_ASSERT_FALSE(handoff.publish());
+    TEST_ASSERT_TRUE(handoff.pending());
+    // Frame 1 was never acquired, so publishing 2 drops it
+    fillFrame(handoff.back(), 2);
+    TEST_ASSERT_TRUE(handoff.publish());
+
+    TEST_ASSERT_TRUE(handoff.acquire());
+    TEST_ASSERT_EQUAL_UINT32(2, handoff.front().sequence);
+    TEST_ASSERT_FALSE(handoff.pending());
+    TEST_ASSERT_FALSE(handoff.acquire());
+    TEST_ASSERT_EQUAL_UINT32(2, handoff.front().sequence);
+}
+
+static void test_threads_see_whole_frames_in_order() {
+    static FrameHandoff<Frame> handoff;
+    handoff.forEachBuffer([](Frame &frame) { fillFrame(frame, 0); });
+
+    std::atomic<bool> done{false};
+    uint32_t dropped = 0;
+    std::thread producer([&] {
+        for (uint32_t sequence = 1; sequence <= FRAMES; sequence++) {
+            fillFrame(handoff.back(), sequence);
+            if (handoff.publish()) dropped++;
+            // Let the consumer in often, or it would hardly ever acquire one
+            if (sequence % 4 == 0) std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint32_t acquired = 0;
+    uint32_t torn = 0;
+    uint32_t outOfOrder = 0;
+    uint32_t last = 0;
+    for (;;) {
+        bool finished = done.load(std::memory_order_acquire);
+        if (handoff.acquire()) {
+            const Frame &frame = handoff.front();
+            uint32_t sequence = frame.sequence;
+            if (!frameIntact(frame)) torn++;
+            if (sequence <= last) outOfOrder++;
+            // The front frame must stay put while the producer runs on
+            std::this_thread::yield();
+            if (frame.sequence != sequence || !frameIntact(frame)) torn++;
+            last = sequence;
+            acquired++;
+        } else if (finished) {
+            break;
+        }
+    }
+    producer.join();
+
+    char message[96];
+    snprintf(message, sizeof(message), "%u acquired, %u dropped, %u torn, %u out of order",
+             acquired, dropped, torn, outOfOrder);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+    // The newest frame always gets through, and none is both shown and dropped
+    TEST_ASSERT_EQUAL_UINT32(FRAMES, last);
+    TEST_ASSERT_EQUAL_UINT32(FRAMES, acquired + dropped);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_publish_reports_replaced_frame);
+    RUN_TEST(test_threads_see_whole_frames_in_order);
+    return UNITY_END();
+}
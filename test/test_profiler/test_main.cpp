@@ -0,0 +1,85 @@
+// Profiler with the sim phases closed on one thread and the render side
+// reading on another, the way the pipelined tasks use it. Build it with
+// ThreadSanitizer too:
+//
+//   pio test -e native -f test_profiler
+//   pio test -e native_tsan
+#include <Arduino.h>
+#include <unity.h>
+#include <atomic>
+#include <thread>
+
+#include "Profiler.h"
+
+#define TICKS 20000
+#define SWIM_NS 700
+#define PHYSICS_NS 500
+
+void setUp() {}
+void tearDown() {}
+
+static void test_ticks_land_on_the_next_frame() {
+    static Profiler profiler;
+    for (uint32_t ns = 1000; ns <= 3000; ns += 1000) {
+        profiler.add(PROFILE_SWIM, ns);
+        profiler.commitTick();
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, profiler.samples(PROFILE_SWIM));
+
+    profiler.commitFrame(0, 0);
+    TEST_ASSERT_EQUAL_UINT32(3, profiler.samples(PROFILE_SWIM));
+    TEST_ASSERT_TRUE(profiler.total(PROFILE_SWIM) == 6000);
+    ProfileStats stats = profiler.stats(PROFILE_SWIM);
+    TEST_ASSERT_EQUAL_UINT32(1000, stats.min);
+    TEST_ASSERT_EQUAL_UINT32(3000, stats.p99);
+    TEST_ASSERT_EQUAL_UINT32(1, profiler.samples(PROFILE_DRAW));
+}
+
+static void test_sim_thread_ticks_while_render_reads() {
+    static Profiler profiler;
+    std::atomic<bool> done{false};
+    std::thread sim([&] {
+        for (int i = 1; i <= TICKS; i++) {
+            profiler.add(PROFILE_SWIM, SWIM_NS);
+            profiler.add(PROFILE_PHYSICS, PHYSICS_NS);
+            profiler.commitTick();
+            if (i % 4 == 0) std::this_thread::yield();
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    uint32_t frames = 0;
+    uint32_t mixed = 0;
+    for (;;) {
+        bool finished = done.load(std::memory_order_acquire);
+        profiler.add(PROFILE_DRAW, 100);
+        profiler.commitFrame(frames, frames);
+        frames++;
+        // A sample torn between ticks would no longer be one tick's value
+        ProfileStats swim = profiler.stats(PROFILE_SWIM);
+        ProfileStats physics = profiler.stats(PROFILE_PHYSICS);
+        if (profiler.samples(PROFILE_SWIM) > 0 && (swim.min != SWIM_NS || swim.p99 != SWIM_NS)) mixed++;
+        if (profiler.samples(PROFILE_PHYSICS) > 0 && (physics.min != PHYSICS_NS || physics.p99 != PHYSICS_NS)) mixed++;
+        if (finished) break;
+        std::this_thread::yield();
+    }
+    sim.join();
+
+    uint32_t samples = profiler.samples(PROFILE_SWIM);
+    char message[96];
+    snprintf(message, sizeof(message), "%u frames, %u of %u ticks taken in", frames, samples, TICKS);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(0, mixed);
+    // Ticks queued past a full ring are dropped, never half-counted
+    TEST_ASSERT_TRUE(samples > 0 && samples <= TICKS);
+    TEST_ASSERT_EQUAL_UINT32(samples, profiler.samples(PROFILE_PHYSICS));
+    TEST_ASSERT_TRUE(profiler.total(PROFILE_SWIM) == (uint64_t)samples * SWIM_NS);
+    TEST_ASSERT_EQUAL_UINT32(frames, profiler.samples(PROFILE_DRAW));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_ticks_land_on_the_next_frame);
+    RUN_TEST(test_sim_thread_ticks_while_render_reads);
+    return UNITY_END();
+}
@@ -0,0 +1,295 @@
+// TransferQueue against a bus that, like DMA, only reads a span's pixels
+// when the transfer finishes, some polls after push(). Fencing a buffer has
+// to wait that out, and every queued span must reach the panel exactly once.
+// A second bus takes real time per pixel, as SPI does, to check that a push
+// task drains the queue while the enqueuing side is busy with other work.
+//
+//   pio test -e native -f test_transfer_queue
+#include <Arduino.h>
+#include <unity.h>
+#include <chrono>
+#include <vector>
+
+#include "TransferQueue.h"
+
+#define PANEL_WIDTH 64
+#define PANEL_HEIGHT 64
+#define BUSY_POLLS 3
+// A frame of short spans, about what the pond sends, and how long a pixel
+// takes on the wire: 16 bits at 40 MHz, rounded up
+#define FRAME_SPANS 220
+#define FRAME_SPAN_PIXELS 3
+#define WIRE_NS_PER_PIXEL 500
+// Simulating the next tick, during which nothing pumps the queue
+#define SIMULATE_MS 20
+
+class MockSpanBus : public SpanBus {
+    public:
+        uint16_t panel[PANEL_WIDTH * PANEL_HEIGHT] = {};
+        // Times each panel pixel was written
+        uint8_t writes[PANEL_WIDTH * PANEL_HEIGHT] = {};
+        int pushes = 0;
+        int retired = 0;
+        bool pushedWhileBusy = false;
+
+        void push(int x, int y, int len, const uint16_t *pixels) override {
+            if (live_) pushedWhileBusy = true;
+            live_ = pixels;
+            x_ = x;
+            y_ = y;
+            len_ = len;
+            polls_ = BUSY_POLLS;
+            pushes++;
+        }
+
+        bool busy() override {
+            if (!live_) return false;
+            if (polls_-- > 0) return true;
+            retire();
+            return false;
+        }
+
+        void wait() override {
+            if (live_) retire();
+        }
+
+        bool reading(const uint16_t *first, const uint16_t *last) const {
+            return live_ && live_ + len_ > first && live_ < last;
+        }
+
+    private:
+        const uint16_t *live_ = nullptr;
+        int x_ = 0;
+        int y_ = 0;
+        int len_ = 0;
+        int polls_ = 0;
+
+        // The pixels are only read now, so a buffer reused early shows up
+        void retire() {
+            for (int i = 0; i < len_; i++) {
+                panel[y_ * PANEL_WIDTH + x_ + i] = live_[i];
+                writes[y_ * PANEL_WIDTH + x_ + i]++;
+            }
+            live_ = nullptr;
+            retired++;
+        }
+};
+
+// Busy for WIRE_NS_PER_PIXEL per pixel of real time after push(), plus a
+// fixed setup cost. Only ever called from one thread, the queue's bus side.
+class LatencySpanBus : public SpanBus {
+    public:
+        uint16_t panel[PANEL_WIDTH * PANEL_HEIGHT] = {};
+        int pushes = 0;
+        int retired = 0;
+
+        void push(int x, int y, int len, const uint16_t *pixels) override {
+            live_ = pixels;
+            x_ = x;
+            y_ = y;
+            len_ = len;
+            done_ = Clock::now() + std::chrono::nanoseconds(2000 + WIRE_NS_PER_PIXEL * len);
+            pushes++;
+        }
+
+        bool busy() override {
+            if (!live_) return false;
+            if (Clock::now() < done_) return true;
+            retire();
+            return false;
+        }
+
+        void wait() override {
+            while (busy()) {}
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+        const uint16_t *live_ = nullptr;
+        int x_ = 0;
+        int y_ = 0;
+        int len_ = 0;
+        Clock::time_point done_;
+
+        void retire() {
+            for (int i = 0; i < len_; i++) panel[y_ * PANEL_WIDTH + x_ + i] = live_[i];
+            live_ = nullptr;
+            retired++;
+        }
+};
+
+static MockSpanBus bus;
+static uint16_t buffers[TRANSFER_SOURCES][PANEL_WIDTH * PANEL_HEIGHT];
+
+static void fillBuffer(int source, uint16_t value) {
+    for (uint16_t &p : buffers[source]) p = value;
+}
+
+void setUp() {
+    bus = MockSpanBus();
+}
+
+void tearDown() {}
+
+static void test_fence_waits_for_span_in_flight() {
+    TransferQueue queue(bus);
+    fillBuffer(0, 0x1111);
+    queue.enqueue(0, 0, 0, PANEL_WIDTH, buffers[0]);
+    TEST_ASSERT_TRUE(bus.reading(buffers[0], buffers[0] + PANEL_WIDTH));
+
+    queue.fence(0);
+    TEST_ASSERT_FALSE(bus.reading(buffers[0], buffers[0] + PANEL_WIDTH * PANEL_HEIGHT));
+    // Reusing the buffer now must not change what reached the panel
+    fillBuffer(0, 0x2222);
+    queue.flush();
+    for (int x = 0; x < PANEL_WIDTH; x++) TEST_ASSERT_EQUAL_INT(0x1111, bus.panel[x]);
+}
+
+static void test_fence_leaves_other_source_queued() {
+    TransferQueue queue(bus);
+    fillBuffer(0, 0x1111);
+    fillBuffer(1, 0x3333);
+    // Source 0's spans go first, so fencing it can't drain source 1 as well
+    for (int y = 0; y < 8; y++) queue.enqueue(0, 0, y, PANEL_WIDTH, buffers[0] + y * PANEL_WIDTH);
+    for (int y = 8; y < 16; y++) queue.enqueue(1, 0, y, PANEL_WIDTH, buffers[1] + y * PANEL_WIDTH);
+
+    queue.fence(0);
+    TEST_ASSERT_EQUAL_INT(8, bus.retired);
+    TEST_ASSERT_TRUE(queue.pending() > 0);
+    fillBuffer(0, 0x2222);
+    queue.flush();
+    for (int y = 0; y < 16; y++) {
+        TEST_ASSERT_EQUAL_INT(y < 8 ? 0x1111 : 0x3333, bus.panel[y * PANEL_WIDTH]);
+    }
+}
+
+static void test_every_span_retired_once() {
+    TransferQueue queue(bus);
+    fillBuffer(0, 0x1111);
+    fillBuffer(1, 0x3333);
+    // Short spans covering the panel once, from alternating buffers, more
+    // of them than the queue holds so enqueue has to wait for room too
+    int spans = 0;
+    uint32_t pixels = 0;
+    for (int y = 0; y < PANEL_HEIGHT; y++) {
+        for (int x = 0; x < PANEL_WIDTH; x += 4) {
+            int source = (x / 4 + y) % TRANSFER_SOURCES;
+            queue.enqueue(source, x, y, 4, buffers[source] + y * PANEL_WIDTH + x);
+            spans++;
+            pixels += 4;
+            if (spans % 97 == 0) queue.fence(source);
+            queue.pump();
+        }
+    }
+    TEST_ASSERT_TRUE(spans > TRANSFER_QUEUE_SIZE);
+    queue.flush();
+
+    TEST_ASSERT_EQUAL_INT(0, (int)queue.pending());
+    TEST_ASSERT_FALSE(bus.pushedWhileBusy);
+    TEST_ASSERT_EQUAL_INT(spans, bus.pushes);
+    TEST_ASSERT_EQUAL_INT(spans, bus.retired);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)spans, queue.queuedSpans());
+    TEST_ASSERT_EQUAL_UINT32(pixels, queue.queuedPixels());
+    for (int i = 0; i < PANEL_WIDTH * PANEL_HEIGHT; i++) TEST_ASSERT_EQUAL_INT(1, bus.writes[i]);
+}
+
+static void test_indexed_spans_split_and_expand() {
+    TransferQueue queue(bus);
+    Palette palette;
+    palette.begin(true);
+    uint8_t gray = palette.ink(0x8410);
+    static uint8_t indices[PANEL_WIDTH * PANEL_HEIGHT];
+    for (uint8_t &i : indices) i = gray;
+
+    // One span longer than the expansion buffer goes out in pieces, each
+    // expanded to byte-swapped RGB565 only when the bus is free
+    int len = TRANSFER_EXPAND_PIXELS + PANEL_WIDTH;
+    queue.enqueue(0, 0, 0, len, indices, palette);
+    queue.fence(0);
+    TEST_ASSERT_EQUAL_INT(2, bus.pushes);
+    TEST_ASSERT_EQUAL_INT(2, bus.retired);
+    TEST_ASSERT_EQUAL_UINT32(2, queue.queuedSpans());
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)len, queue.queuedPixels());
+    for (int i = 0; i < len; i++) TEST_ASSERT_EQUAL_INT(0x1084, bus.panel[i]);
+}
+
+// Queues one frame of short spans from source, over rows 0..
+static void enqueueFrame(TransferQueue &queue, int source) {
+    int perRow = PANEL_WIDTH / (2 * FRAME_SPAN_PIXELS);
+    for (int i = 0; i < FRAME_SPANS; i++) {
+        int x = (i % perRow) * 2 * FRAME_SPAN_PIXELS;
+        int y = i / perRow;
+        queue.enqueue(source, x, y, FRAME_SPAN_PIXELS, buffers[source] + y * PANEL_WIDTH + x);
+    }
+}
+
+// Stands in for a tick of simulation: work that never touches the queue
+static void simulate() {
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(SIMULATE_MS);
+    volatile uint32_t work = 0;
+    while (std::chrono::steady_clock::now() < end) work = work + 1;
+}
+
+// The difference the push task makes: pumped only as spans are queued, a
+// frame barely starts before the simulation takes over
+static void test_pumped_queue_stalls_while_simulating() {
+    static LatencySpanBus slowBus;
+    TransferQueue queue(slowBus);
+    fillBuffer(0, 0x1111);
+    enqueueFrame(queue, 0);
+    simulate();
+    TEST_ASSERT_TRUE(slowBus.retired < FRAME_SPANS / 2);
+    queue.flush();
+    TEST_ASSERT_EQUAL_INT(FRAME_SPANS, slowBus.retired);
+}
+
+// The push task never stops, so its queue and bus live for the whole run
+static LatencySpanBus pushedBus;
+static TransferQueue pushedQueue(pushedBus);
+
+static void test_push_task_drains_while_simulating() {
+    TEST_ASSERT_TRUE(pushedQueue.startPushTask(0));
+    fillBuffer(0, 0x1111);
+    enqueueFrame(pushedQueue, 0);
+    simulate();
+    // Everything went out without a pump, fence or flush from this side
+    TEST_ASSERT_EQUAL_INT(0, (int)pushedQueue.pending());
+    pushedQueue.fence(0);
+    TEST_ASSERT_EQUAL_INT(FRAME_SPANS, pushedBus.retired);
+}
+
+static void test_push_task_fences_sources() {
+    TEST_ASSERT_TRUE(pushedQueue.startPushTask(0));
+    for (int frame = 0; frame < 20; frame++) {
+        int source = frame % TRANSFER_SOURCES;
+        uint16_t value = 0x1000 + frame;
+        // As render does: fence the buffer, redraw it, queue its spans
+        pushedQueue.fence(source);
+        fillBuffer(source, value);
+        enqueueFrame(pushedQueue, source);
+        pushedQueue.fence(source);
+        // The buffer is ours again, and the panel shows what it held
+        fillBuffer(source, 0xdead);
+        for (int i = 0; i < FRAME_SPANS; i++) {
+            int perRow = PANEL_WIDTH / (2 * FRAME_SPAN_PIXELS);
+            int x = (i % perRow) * 2 * FRAME_SPAN_PIXELS;
+            int y = i / perRow;
+            TEST_ASSERT_EQUAL_INT(value, pushedBus.panel[y * PANEL_WIDTH + x]);
+        }
+    }
+    pushedQueue.flush();
+    TEST_ASSERT_EQUAL_INT(pushedBus.pushes, pushedBus.retired);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fence_waits_for_span_in_flight);
+    RUN_TEST(test_fence_leaves_other_source_queued);
+    RUN_TEST(test_every_span_retired_once);
+    RUN_TEST(test_indexed_spans_split_and_expand);
+    RUN_TEST(test_pumped_queue_stalls_while_simulating);
+    // Last, as the push task keeps running once started
+    RUN_TEST(test_push_task_drains_while_simulating);
+    RUN_TEST(test_push_task_fences_sources);
+    return UNITY_END();
+}